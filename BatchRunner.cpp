@@ -0,0 +1,304 @@
+/*****************************************************************************************
+/* File: BatchRunner.cpp
+/* Desc: Plays many headless games on all the workers of the thread pool, each one with its
+/*       own seed and a policy (random, scripted or the bot), and writes the result of every
+/*       game as it ends.
+/*       Usage: BatchRunner [--games N] [--seed S] [--policy random|scripted|bot]
+/*                          [--script file] [--max-pieces P] [--format ndjson|csv]
+/*                          [--output file] [--threads T] [--pin 0|1]
+/*                          [--bot-search beam|expectimax] [--bot-depth D]
+/*                          [--bot-preview P] [--bot-time-us U]
+/*****************************************************************************************/
+
+#include "Bot.h"
+#include "GameCore.h"
+#include "Policies.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	enum Policy { ePolicyRandom, ePolicyScripted, ePolicyBot };
+	enum Format { eFormatNdjson, eFormatCsv };
+
+	struct Options
+	{
+		int games = 100;
+		uint64_t seed = 1;							// Game i is played with the seed seed + i
+		Policy policy = ePolicyRandom;
+		std::string script_path;
+		int max_pieces = 100000;					// A game that reaches this number of pieces is stopped
+		Format format = eFormatNdjson;
+		std::string output;							// Empty = stdout
+		int threads = 0;
+		bool pin_threads = false;
+		Bot::Settings bot;
+	};
+
+	struct GameResult
+	{
+		int game;
+		uint64_t seed;
+		int score;
+		int pieces;
+		double duration_ms;
+		const char* end;							// Why the game ended
+	};
+
+	/* 
+	======================================									
+	Read a script: one line per piece, with the inputs given to the piece in order (L = left,
+	R = right, D = down, Z = rotate, X = drop). A piece that isn't dropped by its line is dropped
+	after it. Empty lines and lines starting with # are skipped
+
+	Returns false if the file can't be read or has no piece.
+	====================================== 
+	*/
+	bool ReadScript(const std::string& path, std::vector<std::vector<int>>* script)
+	{
+		FILE* file = fopen(path.c_str(), "r");
+		if (file == nullptr)
+			return false;
+
+		char line[1024];
+		while (fgets(line, sizeof(line), file) != nullptr)
+		{
+			if (line[0] == '#' || line[0] == '\n' || line[0] == '\r' || line[0] == '\0')
+				continue;
+
+			std::vector<int> inputs;
+			for (const char* c = line; *c != '\0'; c++)
+			{
+				switch (*c)
+				{
+				case 'L':	inputs.push_back(GameCore::eInputLeft);		break;
+				case 'R':	inputs.push_back(GameCore::eInputRight);	break;
+				case 'D':	inputs.push_back(GameCore::eInputDown);		break;
+				case 'Z':	inputs.push_back(GameCore::eInputRotate);	break;
+				case 'X':	inputs.push_back(GameCore::eInputDrop);		break;
+				}
+			}
+			script->push_back(inputs);
+		}
+
+		fclose(file);
+		return !script->empty();
+	}
+
+	// The line of the script of the piece, the script starts again when it is over
+	void PlayScriptedPiece(GameCore& core, const std::vector<std::vector<int>>& script)
+	{
+		int pieces = core.GetPieceCount();
+		for (int input : script[pieces % script.size()])
+		{
+			core.Step(input, 0);
+			if (core.GetPieceCount() != pieces)
+				return;
+		}
+		core.Step(GameCore::eInputDrop, 0);
+	}
+
+	/* 
+	======================================									
+	Play a whole game. The random policy draws from its own generator seeded with the game seed,
+	and the bot searches without a time budget unless one is set, so the game is the same on every
+	run
+	====================================== 
+	*/
+	GameResult PlayGame(int game, const Options& options, const std::vector<std::vector<int>>& script)
+	{
+		Clock::time_point start = Clock::now();
+
+		GameResult result;
+		result.game = game;
+		result.seed = options.seed + (uint64_t) game;
+		result.end = "piece_limit";
+
+		GameCore core(result.seed);
+		Random random(result.seed ^ 0x5bd1e995u);
+
+		std::unique_ptr<Bot> bot;
+		if (options.policy == ePolicyBot)
+			bot = std::make_unique<Bot>(options.bot);
+
+		while (core.GetPieceCount() < options.max_pieces)
+		{
+			if (core.IsGameOver())
+			{
+				result.end = "top_out";
+				break;
+			}
+
+			if (options.policy == ePolicyBot)
+			{
+				if (!bot->Play(core))
+				{
+					result.end = "no_move";
+					break;
+				}
+			}
+			else if (options.policy == ePolicyScripted)
+				PlayScriptedPiece(core, script);
+			else
+				Policies::PlayRandomPiece(core, random);
+		}
+
+		result.score = core.GetScore();
+		result.pieces = core.GetPieceCount();
+		result.duration_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		return result;
+	}
+
+	void PrintResult(FILE* file, Format format, const GameResult& result)
+	{
+		if (format == eFormatCsv)
+		{
+			fprintf(file, "%d,%llu,%d,%d,%.3f,%s\n", result.game, (unsigned long long) result.seed,
+				result.score, result.pieces, result.duration_ms, result.end);
+		}
+		else
+		{
+			fprintf(file, "{\"game\":%d,\"seed\":%llu,\"score\":%d,\"pieces\":%d,\"duration_ms\":%.3f,\"end\":\"%s\"}\n",
+				result.game, (unsigned long long) result.seed, result.score, result.pieces, result.duration_ms, result.end);
+		}
+	}
+
+	const char* kCsvHeader = "game,seed,score,pieces,duration_ms,end\n";
+
+	// Reads the options, returns false if one is unknown or has a wrong value
+	bool ParseOptions(int argc, char** argv, Options* options)
+	{
+		if (argc % 2 == 0)
+		{
+			fprintf(stderr, "Option %s has no value\n", argv[argc - 1]);
+			return false;
+		}
+
+		for (int i = 1; i + 1 < argc; i += 2)
+		{
+			const char* value = argv[i + 1];
+
+			if (strcmp(argv[i], "--games") == 0)				options->games = atoi(value);
+			else if (strcmp(argv[i], "--seed") == 0)			options->seed = strtoull(value, nullptr, 10);
+			else if (strcmp(argv[i], "--script") == 0)			options->script_path = value;
+			else if (strcmp(argv[i], "--max-pieces") == 0)		options->max_pieces = atoi(value);
+			else if (strcmp(argv[i], "--output") == 0)			options->output = value;
+			else if (strcmp(argv[i], "--threads") == 0)			options->threads = atoi(value);
+			else if (strcmp(argv[i], "--pin") == 0)				options->pin_threads = atoi(value) != 0;
+			else if (strcmp(argv[i], "--bot-depth") == 0)		options->bot.depth = atoi(value);
+			else if (strcmp(argv[i], "--bot-preview") == 0)		options->bot.preview = atoi(value);
+			else if (strcmp(argv[i], "--bot-time-us") == 0)		options->bot.time_budget_us = atoi(value);
+			else if (strcmp(argv[i], "--policy") == 0)
+			{
+				if (strcmp(value, "random") == 0)				options->policy = ePolicyRandom;
+				else if (strcmp(value, "scripted") == 0)		options->policy = ePolicyScripted;
+				else if (strcmp(value, "bot") == 0)				options->policy = ePolicyBot;
+				else
+				{
+					fprintf(stderr, "Unknown policy %s\n", value);
+					return false;
+				}
+			}
+			else if (strcmp(argv[i], "--format") == 0)
+			{
+				if (strcmp(value, "ndjson") == 0)				options->format = eFormatNdjson;
+				else if (strcmp(value, "csv") == 0)				options->format = eFormatCsv;
+				else
+				{
+					fprintf(stderr, "Unknown format %s\n", value);
+					return false;
+				}
+			}
+			else if (strcmp(argv[i], "--bot-search") == 0)
+			{
+				if (strcmp(value, "beam") == 0)					options->bot.search = Bot::eSearchBeam;
+				else if (strcmp(value, "expectimax") == 0)		options->bot.search = Bot::eSearchExpectimax;
+				else
+				{
+					fprintf(stderr, "Unknown search %s\n", value);
+					return false;
+				}
+			}
+			else
+			{
+				fprintf(stderr, "Unknown option %s\n", argv[i]);
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	options.bot.time_budget_us = 0;
+	options.bot.table_megabytes = 4;				// A bot for every game being played
+	options.bot.single_thread = true;				// The games already keep every worker busy
+
+	if (!ParseOptions(argc, argv, &options))
+		return 2;
+
+	std::vector<std::vector<int>> script;
+	if (options.policy == ePolicyScripted && !ReadScript(options.script_path, &script))
+	{
+		fprintf(stderr, "Can't read the script %s\n", options.script_path.c_str());
+		return 1;
+	}
+
+	FILE* file = stdout;
+	if (!options.output.empty())
+	{
+		file = fopen(options.output.c_str(), "w");
+		if (file == nullptr)
+		{
+			fprintf(stderr, "Can't write %s\n", options.output.c_str());
+			return 1;
+		}
+	}
+
+	if (options.format == eFormatCsv)
+		fprintf(file, "%s", kCsvHeader);
+
+	// The games are the parallel work: every bot searches on the worker playing its game
+	ThreadPool::SetGlobalThreads(options.threads, options.pin_threads);
+	ThreadPool& pool = ThreadPool::GetGlobal();
+
+	std::mutex mutex;
+	int64_t total_score = 0;
+	int64_t total_pieces = 0;
+
+	Clock::time_point start = Clock::now();
+	pool.ParallelFor(options.games, [&](int /*worker*/, int game) {
+		GameResult result = PlayGame(game, options, script);
+
+		// Every result is written as soon as its game ends
+		std::lock_guard<std::mutex> lock(mutex);
+		PrintResult(file, options.format, result);
+		fflush(file);
+		total_score += result.score;
+		total_pieces += result.pieces;
+	});
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	if (file != stdout)
+		fclose(file);
+
+	// The summary doesn't mix with the results written to stdout
+	FILE* summary = file == stdout ? stderr : stdout;
+	fprintf(summary, "%d games, %lld pieces, %lld lines in %.3f s on %d workers: %.1f games/s, %.1f pieces/s\n",
+		options.games, (long long) total_pieces, (long long) total_score, seconds, pool.GetWorkerCount(),
+		options.games / seconds, total_pieces / seconds);
+
+	return 0;
+}
@@ -0,0 +1,51 @@
+/*****************************************************************************************
+/* File: Bits.h
+/* Desc: Portable bit tricks on 64 bit words (population count, lowest set bit)
+/*****************************************************************************************/
+
+#ifndef _BITS_
+#define _BITS_
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Bits
+{
+	// Number of bits set
+	inline int PopCount(uint64_t x)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		return (int) __popcnt64(x);
+#elif defined(_MSC_VER)
+		x = x - ((x >> 1) & 0x5555555555555555ull);
+		x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+		x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+		return (int) ((x * 0x0101010101010101ull) >> 56);
+#else
+		return __builtin_popcountll(x);
+#endif
+	}
+
+	// Index of the lowest bit set, x must not be 0
+	inline int CountTrailingZeros(uint64_t x)
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+		unsigned long index;
+		_BitScanForward64(&index, x);
+		return (int) index;
+#elif defined(_MSC_VER)
+		unsigned long index;
+		if (_BitScanForward(&index, (unsigned long) x))
+			return (int) index;
+		_BitScanForward(&index, (unsigned long) (x >> 32));
+		return (int) index + 32;
+#else
+		return __builtin_ctzll(x);
+#endif
+	}
+}
+
+#endif // _BITS_
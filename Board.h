@@ -1,49 +1,394 @@
 /*****************************************************************************************
 /* File: Board.h
 /* Desc: Board of the game. A matrix of n x n holes.
+/*       The dimensions are template parameters, Board is the classic 10 x 20 board
 /*****************************************************************************************/
 
 #ifndef _BOARD_
 #define _BOARD_
 
+#include "BoardLine.h"
 #include "Pieces.h"
+#include "Zobrist.h"
+#include <cstdint>
 
-class Board
+template <int W, int H>
+class BasicBoard
 {
 
 public:
 
-	Board (int screen_width, int screen_height);
+	static const int kBoardWidth = W;				// Board width in blocks 
+	static const int kBoardHeight = H;				// Board height in blocks
+	static const int kPieceBlocks = 5;				// Number of horizontal and vertical blocks of a matrix piece
+
+	static_assert(H <= Zobrist::kMaxLines, "The deleted lines are kept in a 32 bit mask");
+
+	typedef typename LineTraits<W>::Line Line;		// Occupancy mask of one line (bit x = column x)
+
+	// Journal of a StorePiece and the following DeletePossibleLines, Unmake restores the board from it
+	struct Undo
+	{
+		int y;										// First line of the board touched by the piece
+		Line lines [Pieces::kPieceCells];			// Lines y.. before storing the piece
+		uint32_t cleared_rows;						// Lines deleted afterwards, filled by DeletePossibleLines(&undo.cleared_rows)
+		uint8_t heights [kBoardWidth];
+		uint64_t hash;
+	};
+
+	BasicBoard ();
 
-	int GetXPosInPixels(int pos) const;
-	int GetYPosInPixels(int pos) const;
 	bool IsFreeBlock(int x, int y) const;
 	bool IsGameOver() const;
 	bool IsPossibleMovement(int x, int y, int piece, int rotation) const;
+	int GetDropPosition(int x, int y, int piece, int rotation) const;
+	int GetColumnHeight(int x) const;
+	uint64_t GetHash() const;
+	const Line& GetLine(int y) const;
 
-	void StorePiece(int x, int y, int piece, int rotation);
-	int DeletePossibleLines();
-
-	int BoardPosition() const;						// Center position of the board from the left of the screen
-
-	static const int kBoardLineWidth = 6;			// Width of each of the two lines that delimit the board
-	static const int kBlockSize = 16;				// Width and Height of each block of a piece
-	static const int kBoardWidth = 10;				// Board width in blocks 
-	static const int kBoardHeight = 20;				// Board height in blocks
-	static const int kMinVerticalMargin = 5;		// Minimum vertical margin for the board limit 		
-	static const int kMinHorizontalMargin = 5;		// Minimum horizontal margin for the board limit
-	static const int kPieceBlocks = 5;				// Number of horizontal and vertical blocks of a matrix piece
+	void StorePiece(int x, int y, int piece, int rotation, Undo* undo = nullptr);
+	int DeletePossibleLines(uint32_t* cleared_rows = nullptr);
+	void Unmake(const Undo& undo);
 
 private:
 
-	enum { ePosFree, ePosFilled };			// POS_FREE = free position of the board; POS_FILLED = filled position of the board
-	int board_ [kBoardWidth][kBoardHeight];	// Board that contains the pieces
-	int screen_height_;
-	int screen_width_;
+	typedef LineTraits<W> Traits;
+
+	Line board_ [kBoardHeight];				// Board that contains the pieces, one occupancy mask per line (bit x = column x)
+	uint8_t heights_ [kBoardWidth];			// Height of the highest block of each column over the bottom of the board (0 = empty column)
+	uint64_t hash_;							// Zobrist hash of the filled blocks
 
 	void InitBoard();
-	void DeleteLine(int y);
+	void UpdateHeights();
 
 };
 
+typedef BasicBoard<10, 20> Board;			// Classic board
+
+template <int W, int H>
+BasicBoard<W, H>::BasicBoard()
+{
+	//Init the board blocks with free positions
+	this->InitBoard();
+}
+
+template <int W, int H>
+void BasicBoard<W, H>::InitBoard()
+{
+	for (int j = 0; j < kBoardHeight; j++)
+		this->board_[j] = Traits::Zero();
+
+	for (int i = 0; i < kBoardWidth; i++)
+		this->heights_[i] = 0;
+
+	this->hash_ = 0;
+}
+
+/* 
+======================================									
+Compute the height of every column from the lines of the board, from the top down: the first
+line where a column has a block gives its height
+====================================== 
+*/
+template <int W, int H>
+void BasicBoard<W, H>::UpdateHeights()
+{
+	Line pending = Traits::Full();		// Columns whose highest block has not been found yet
+
+	for (int i = 0; i < kBoardWidth; i++)
+		this->heights_[i] = 0;
+
+	for (int j = 0; j < kBoardHeight && Traits::Any(pending); j++)
+	{
+		Line found = this->board_[j] & pending;
+		pending ^= found;
+
+		Traits::ForEachBit(found, [&](int i) { this->heights_[i] = (uint8_t) (kBoardHeight - j); });
+	}
+}
+
+/* 
+======================================									
+Store a piece in the board by filling the blocks
+
+Parameters:
+
+>> x:		Horizontal position in blocks
+>> y:		Vertical position in blocks
+>> piece:	Piece to draw
+>> rotation:	1 of the 4 possible rotations
+>> undo:	If not null, receives what is needed to restore the board with Unmake
+====================================== 
+*/
+template <int W, int H>
+void BasicBoard<W, H>::StorePiece (int x, int y, int piece, int rotation, Undo* undo)
+{
+	const Pieces::Shape& shape = Pieces::GetShape(piece, rotation);
+	int shift = x + shape.min_x;
+
+	if (undo != nullptr)
+	{
+		undo->y = y + shape.min_y;
+		for (int k = 0; k < Pieces::kPieceCells; k++)
+		{
+			int j = undo->y + k;
+			undo->lines[k] = (j >= 0 && j < kBoardHeight) ? this->board_[j] : Traits::Zero();
+		}
+		undo->cleared_rows = 0;
+		for (int i = 0; i < kBoardWidth; i++)
+			undo->heights[i] = this->heights_[i];
+		undo->hash = this->hash_;
+	}
+
+	// Store each line of the bounding box of the piece into the board, the holes of the piece are zero bits of the mask
+	for (int k = 0; k < Pieces::kPieceCells; k++)
+	{
+		int j = y + shape.min_y + k;
+		if (shape.rows[k] != 0 && j >= 0)
+		{
+			Line line = Traits::Piece(shape.rows[k], shift);
+			this->board_[j] |= line;
+			this->hash_ ^= Traits::Key(j, line);
+		}
+	}
+
+	// Raise the columns under the piece up to its highest block in each column
+	for (int k = 0; k < Pieces::kPieceCells; k++)
+	{
+		int i = x + shape.cells_x[k];
+		int height = kBoardHeight - (y + shape.cells_y[k]);
+		if (height <= kBoardHeight && height > this->heights_[i])
+			this->heights_[i] = (uint8_t) height;
+	}
+}
+
+/* 
+======================================									
+Check if the game is over becase a piece have achived the upper position
+
+Returns true or false
+====================================== 
+*/
+template <int W, int H>
+bool BasicBoard<W, H>::IsGameOver() const
+{
+	//If the first line has blocks, then, game over
+	return Traits::Any(this->board_[0]);
+}
+
+/* 
+======================================									
+Delete all the lines that should be removed
+
+All the full lines are found and the remaining lines are moved down in a single pass, so
+clearing several lines at once copies each line of the board only once.
+
+Parameters:
+
+>> cleared_rows:	If not null, receives a mask of the deleted lines (bit y = line y before deleting)
+
+Returns number of lines deleted.
+====================================== 
+*/
+template <int W, int H>
+int BasicBoard<W, H>::DeletePossibleLines(uint32_t* cleared_rows)
+{
+	int lines_deleted_count = 0;
+	uint32_t cleared = 0;
+
+	// Walk from the bottom up, copying every line that is not full to the next free line from the bottom
+	int dest = kBoardHeight - 1;
+	for (int j = kBoardHeight - 1; j >= 0; j--)
+	{
+		if (this->board_[j] == Traits::Full())
+		{
+			cleared |= 1u << j;
+			lines_deleted_count += 1;
+			this->hash_ ^= Traits::Key(j, this->board_[j]);
+			continue;
+		}
+
+		// Only the lines that move change the hash: their blocks leave line j and enter line dest
+		if (dest != j && Traits::Any(this->board_[j]))
+			this->hash_ ^= Traits::Key(j, this->board_[j]) ^ Traits::Key(dest, this->board_[j]);
+
+		this->board_[dest--] = this->board_[j];
+	}
+
+	// The lines left on top are empty
+	for (; dest >= 0; dest--)
+		this->board_[dest] = Traits::Zero();
+
+	if (cleared != 0)
+		this->UpdateHeights();
+
+	if (cleared_rows != nullptr)
+		*cleared_rows = cleared;
+
+	return lines_deleted_count;
+}
+
+/* 
+======================================									
+Returns 1 (true) if the this block of the board is empty, 0 if it is filled
+
+Parameters:
+
+>> x:		Horizontal position in blocks
+>> y:		Vertical position in blocks
+====================================== 
+*/
+template <int W, int H>
+bool BasicBoard<W, H>::IsFreeBlock (int x, int y) const
+{
+	return !Traits::Test(this->board_[y], x);
+}
+
+/* 
+======================================									
+Restore the board as it was before a StorePiece and the DeletePossibleLines that followed it.
+Several moves are undone in the reverse order they were made
+
+Parameters:
+
+>> undo:	Journal filled by StorePiece and DeletePossibleLines
+====================================== 
+*/
+template <int W, int H>
+void BasicBoard<W, H>::Unmake (const Undo& undo)
+{
+	// Put the deleted lines back, moving up the lines that were above them
+	if (undo.cleared_rows != 0)
+	{
+		int below = Bits::PopCount(undo.cleared_rows);		// Deleted lines under the current line
+
+		for (int j = 0; j < kBoardHeight; j++)
+		{
+			if (undo.cleared_rows & (1u << j))
+			{
+				below--;
+				this->board_[j] = Traits::Full();
+			}
+			else
+			{
+				this->board_[j] = this->board_[j + below];
+			}
+		}
+	}
+
+	// Take the piece out
+	for (int k = 0; k < Pieces::kPieceCells; k++)
+	{
+		int j = undo.y + k;
+		if (j >= 0 && j < kBoardHeight)
+			this->board_[j] = undo.lines[k];
+	}
+
+	for (int i = 0; i < kBoardWidth; i++)
+		this->heights_[i] = undo.heights[i];
+	this->hash_ = undo.hash;
+}
+
+template <int W, int H>
+int BasicBoard<W, H>::GetColumnHeight (int x) const
+{
+	return this->heights_[x];
+}
+
+/* 
+======================================									
+Returns the Zobrist hash of the blocks stored in the board, kept up to date by StorePiece and
+DeletePossibleLines. Boards with the same blocks always have the same hash
+====================================== 
+*/
+template <int W, int H>
+uint64_t BasicBoard<W, H>::GetHash () const
+{
+	return this->hash_;
+}
+
+template <int W, int H>
+const typename BasicBoard<W, H>::Line& BasicBoard<W, H>::GetLine (int y) const
+{
+	return this->board_[y];
+}
+
+/* 
+======================================									
+Returns the vertical position where a piece lands when it is dropped from a free position
+
+When the piece is above the highest block of every column it covers, the landing position is
+found from the column heights and the lowest block of the piece in each column, without
+checking any collision. Otherwise (the piece is under an overhang) it moves down line by line.
+
+Parameters:
+
+>> x:		Horizontal position in blocks
+>> y:		Vertical position in blocks, the piece must not collide there
+>> piece:	Piece to drop
+>> rotation:	1 of the 4 possible rotations
+====================================== 
+*/
+template <int W, int H>
+int BasicBoard<W, H>::GetDropPosition (int x, int y, int piece, int rotation) const
+{
+	const Pieces::Shape& shape = Pieces::GetShape(piece, rotation);
+
+	int landing = kBoardHeight;
+	for (int k = 0; k <= shape.max_x - shape.min_x; k++)
+	{
+		int top = kBoardHeight - this->heights_[x + shape.min_x + k];	// Line of the highest block of the column
+		int lowest = shape.min_y + shape.bottom[k];						// Line of the lowest block of the piece in the column, inside its matrix
+
+		if (y + lowest >= top)
+		{
+			// Below the surface of this column, look for the collision
+			while (this->IsPossibleMovement(x, y + 1, piece, rotation))
+				y++;
+			return y;
+		}
+
+		if (top - 1 - lowest < landing)
+			landing = top - 1 - lowest;
+	}
+
+	return landing;
+}
+
+/* 
+======================================									
+Check if the piece can be stored at this position without any collision
+Returns true if the movement is  possible, false if it not possible
+
+Parameters:
+
+>> x:		Horizontal position in blocks
+>> y:		Vertical position in blocks
+>> piece:	Piece to draw
+>> rotation:	1 of the 4 possible rotations
+====================================== 
+*/
+template <int W, int H>
+bool BasicBoard<W, H>::IsPossibleMovement (int x, int y, int piece, int rotation) const
+{
+	const Pieces::Shape& shape = Pieces::GetShape(piece, rotation);
+
+	// Check if the bounding box of the piece is outside the limits of the board
+	if (x + shape.min_x < 0 || x + shape.max_x > kBoardWidth - 1 || y + shape.max_y > kBoardHeight - 1)
+		return false;
+
+	// Check if the piece have collisioned with a block already stored in the map
+	// Every line of the bounding box is a bitmask that is shifted to its column and ANDed with the board line
+	int shift = x + shape.min_x;
+	for (int k = 0; k < Pieces::kPieceCells; k++)
+	{
+		int j = y + shape.min_y + k;
+		if (shape.rows[k] != 0 && j >= 0 && Traits::Any(this->board_[j] & Traits::Piece(shape.rows[k], shift)))
+			return false;
+	}
+
+	// No collision
+	return true;
+}
+
 #endif // _BOARD_
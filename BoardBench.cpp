@@ -0,0 +1,307 @@
+/*****************************************************************************************
+/* File: BoardBench.cpp
+/* Desc: Microbenchmarks of the hot paths of Board and Pieces. The boards are taken from
+/*       seeded random games, so every run measures the same corpus.
+/*       Usage: BoardBench [output.json]
+/*****************************************************************************************/
+
+#include "Board.h"
+#include "Evaluator.h"
+#include "GameCore.h"
+#include "MoveGenerator.h"
+#include "Pieces.h"
+#include "Placement.h"
+#include "Random.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const int kCorpusGames = 64;				// Games played to build the corpus
+	const uint64_t kCorpusSeed = 12345;
+	const int kQueries = 4096;					// Random queries per benchmark
+	const double kMinSeconds = 0.25;			// Minimum time measured per benchmark
+
+	struct Query
+	{
+		int board;
+		int x, y, piece, rotation;
+	};
+
+	struct Result
+	{
+		std::string name;
+		double ns_per_op;
+		double ops_per_sec;
+	};
+
+	volatile int64_t sink;						// Keeps the results alive so the compiler can't remove the work
+
+	/* 
+	======================================									
+	Play random games and keep a snapshot of the board after every piece
+	====================================== 
+	*/
+	std::vector<Board> BuildCorpus()
+	{
+		std::vector<Board> corpus;
+		Random random(kCorpusSeed);
+
+		for (int game = 0; game < kCorpusGames; game++)
+		{
+			GameCore core(kCorpusSeed + game);
+			while (!core.IsGameOver())
+			{
+				// Random moves and rotations, then drop
+				int rotations = random.NextInt(Pieces::kRotations);
+				int moves = random.NextInt(6);
+				int direction = random.NextInt(2) == 0 ? GameCore::eInputLeft : GameCore::eInputRight;
+				for (int i = 0; i < rotations; i++)
+					core.Step(GameCore::eInputRotate, 0);
+				for (int i = 0; i < moves; i++)
+					core.Step(direction, 0);
+				core.Step(GameCore::eInputDrop, 0);
+
+				corpus.push_back(core.GetBoard());
+			}
+		}
+
+		return corpus;
+	}
+
+	// Random positions of random pieces, most of them near the surface of the board
+	std::vector<Query> BuildMovementQueries(const std::vector<Board>& corpus, Random* random)
+	{
+		std::vector<Query> queries(kQueries);
+		for (Query& query : queries)
+		{
+			query.board = random->NextInt((int) corpus.size());
+			query.piece = random->NextInt(Pieces::kPieceKinds);
+			query.rotation = random->NextInt(Pieces::kRotations);
+			query.x = random->NextInt(Board::kBoardWidth + 2) - 2;
+			query.y = random->NextInt(Board::kBoardHeight + 3) - 3;
+		}
+		return queries;
+	}
+
+	// Random pieces dropped from the top of the board to where they land
+	std::vector<Query> BuildDropQueries(const std::vector<Board>& corpus, Random* random)
+	{
+		std::vector<Query> queries;
+		while ((int) queries.size() < kQueries)
+		{
+			Query query;
+			query.board = random->NextInt((int) corpus.size());
+			query.piece = random->NextInt(Pieces::kPieceKinds);
+			query.rotation = random->NextInt(Pieces::kRotations);
+			query.x = random->NextInt(Board::kBoardWidth + 2) - 2;
+			query.y = Pieces::GetYInitialPosition(query.piece, query.rotation);
+
+			const Board& board = corpus[query.board];
+			if (!board.IsPossibleMovement(query.x, query.y, query.piece, query.rotation))
+				continue;
+
+			while (board.IsPossibleMovement(query.x, query.y + 1, query.piece, query.rotation))
+				query.y++;
+
+			queries.push_back(query);
+		}
+		return queries;
+	}
+
+	/* 
+	======================================									
+	Run a batch of operations until enough time has been measured
+
+	Parameters:
+
+	>> name:	Name of the benchmark
+	>> batch:	Runs a batch of operations and returns how many it did
+	====================================== 
+	*/
+	Result Measure(const std::string& name, const std::function<int64_t()>& batch)
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		batch();								// Warm up
+
+		int64_t ops = 0;
+		double seconds = 0;
+		Clock::time_point start = Clock::now();
+		while (seconds < kMinSeconds)
+		{
+			ops += batch();
+			seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		}
+
+		Result result;
+		result.name = name;
+		result.ns_per_op = seconds * 1e9 / ops;
+		result.ops_per_sec = ops / seconds;
+		printf("%-42s %10.2f ns/op %14.0f ops/s\n", name.c_str(), result.ns_per_op, result.ops_per_sec);
+		return result;
+	}
+
+	bool WriteJson(const std::string& path, const std::vector<Result>& results, int corpus_size)
+	{
+		FILE* file = fopen(path.c_str(), "w");
+		if (file == nullptr)
+			return false;
+
+		fprintf(file, "{\n  \"corpus_boards\": %d,\n  \"benchmarks\": [\n", corpus_size);
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			fprintf(file, "    {\"name\": \"%s\", \"ns_per_op\": %.4f, \"ops_per_sec\": %.1f}%s\n",
+				results[i].name.c_str(), results[i].ns_per_op, results[i].ops_per_sec, i + 1 < results.size() ? "," : "");
+		}
+		fprintf(file, "  ]\n}\n");
+
+		return fclose(file) == 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string output = argc > 1 ? argv[1] : "board_bench.json";
+
+	std::vector<Board> corpus = BuildCorpus();
+	Random random(kCorpusSeed);
+	std::vector<Query> movements = BuildMovementQueries(corpus, &random);
+	std::vector<Query> drops = BuildDropQueries(corpus, &random);
+
+	printf("Corpus: %d boards\n", (int) corpus.size());
+
+	std::vector<Result> results;
+
+	results.push_back(Measure("IsPossibleMovement", [&]() {
+		int64_t possible = 0;
+		for (const Query& query : movements)
+			possible += corpus[query.board].IsPossibleMovement(query.x, query.y, query.piece, query.rotation);
+		sink = possible;
+		return (int64_t) movements.size();
+	}));
+
+	results.push_back(Measure("GetDropPosition", [&]() {
+		int64_t landing = 0;
+		for (const Query& query : drops)
+		{
+			int y = Pieces::GetYInitialPosition(query.piece, query.rotation);
+			landing += corpus[query.board].GetDropPosition(query.x, y, query.piece, query.rotation);
+		}
+		sink = landing;
+		return (int64_t) drops.size();
+	}));
+
+	// Every horizontal position and rotation of the piece, one candidate at a time
+	results.push_back(Measure("Placements (one by one)", [&]() {
+		int64_t landing = 0;
+		for (const Query& query : drops)
+		{
+			const Board& board = corpus[query.board];
+			int y = Pieces::GetYInitialPosition(query.piece, 0);
+			for (int rotation = 0; rotation < Pieces::kRotations; rotation++)
+				for (int x = Placement::kFirstX; x < Placement::kFirstX + Placement::kLanes; x++)
+					if (board.IsPossibleMovement(x, y, query.piece, rotation))
+						landing += board.GetDropPosition(x, y, query.piece, rotation);
+		}
+		sink = landing;
+		return (int64_t) drops.size();
+	}));
+
+	results.push_back(Measure(std::string("Placement::Evaluate ") + Placement::GetInstructionSet(), [&]() {
+		int64_t landing = 0;
+		for (const Query& query : drops)
+		{
+			Placement::Result result;
+			Placement::Evaluate(corpus[query.board], query.piece, Pieces::GetYInitialPosition(query.piece, 0), &result);
+			landing += result.valid[0] + result.landing[0][5];
+		}
+		sink = landing;
+		return (int64_t) drops.size();
+	}));
+
+	// Every position the piece can be locked at from where it appears
+	MoveGenerator generator;
+	results.push_back(Measure("MoveGenerator::Generate", [&]() {
+		int64_t moves = 0;
+		for (const Query& query : drops)
+		{
+			int x = Board::kBoardWidth / 2 + Pieces::GetXInitialPosition(query.piece, query.rotation);
+			int y = Pieces::GetYInitialPosition(query.piece, query.rotation);
+			moves += generator.Generate(corpus[query.board], query.piece, x, y, query.rotation);
+		}
+		sink = moves;
+		return (int64_t) drops.size();
+	}));
+
+	// The pieces are stored in the boards of the corpus themselves and taken out with Unmake, like
+	// the search does, so no board is copied in the measure
+	std::vector<Board> working = corpus;
+	Board::Undo undo;
+	results.push_back(Measure("StorePiece + Unmake", [&]() {
+		int64_t free_blocks = 0;
+		for (const Query& query : drops)
+		{
+			Board& board = working[query.board];
+			board.StorePiece(query.x, query.y, query.piece, query.rotation, &undo);
+			free_blocks += board.IsFreeBlock(query.x + 2, Board::kBoardHeight - 1);
+			board.Unmake(undo);
+		}
+		sink = free_blocks;
+		return (int64_t) drops.size();
+	}));
+
+	// The cost of DeletePossibleLines is the difference with the benchmark above
+	results.push_back(Measure("StorePiece + DeletePossibleLines + Unmake", [&]() {
+		int64_t lines = 0;
+		for (const Query& query : drops)
+		{
+			Board& board = working[query.board];
+			board.StorePiece(query.x, query.y, query.piece, query.rotation, &undo);
+			lines += board.DeletePossibleLines(&undo.cleared_rows);
+			board.Unmake(undo);
+		}
+		sink = lines;
+		return (int64_t) drops.size();
+	}));
+
+	Evaluator evaluator;
+	results.push_back(Measure("Evaluator::Evaluate", [&]() {
+		double score = 0;
+		for (const Board& board : corpus)
+			score += evaluator.Evaluate(board, 0);
+		sink = (int64_t) score;
+		return (int64_t) corpus.size();
+	}));
+
+	results.push_back(Measure("IsGameOver", [&]() {
+		int64_t over = 0;
+		for (const Board& board : corpus)
+			over += board.IsGameOver();
+		sink = over;
+		return (int64_t) corpus.size();
+	}));
+
+	results.push_back(Measure("Pieces::GetBlockType", [&]() {
+		int64_t blocks = 0;
+		for (int piece = 0; piece < Pieces::kPieceKinds; piece++)
+			for (int rotation = 0; rotation < Pieces::kRotations; rotation++)
+				for (int y = 0; y < Pieces::kPieceBlocks; y++)
+					for (int x = 0; x < Pieces::kPieceBlocks; x++)
+						blocks += Pieces::GetBlockType(piece, rotation, y, x);
+		sink = blocks;
+		return (int64_t) Pieces::kPieceKinds * Pieces::kRotations * Pieces::kPieceBlocks * Pieces::kPieceBlocks;
+	}));
+
+	if (!WriteJson(output, results, (int) corpus.size()))
+	{
+		fprintf(stderr, "Can't write %s\n", output.c_str());
+		return 1;
+	}
+
+	return 0;
+}
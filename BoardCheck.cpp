@@ -0,0 +1,487 @@
+/*****************************************************************************************
+/* File: BoardCheck.cpp
+/* Desc: Self check of the fast paths of Board, MoveGenerator and Evaluator against naive
+/*       versions that test the blocks one by one, on seeded random boards. Exits with an
+/*       error at the first mismatches.
+/*       Usage: BoardCheck [--boards N] [--seed S]
+/*****************************************************************************************/
+
+#include "Board.h"
+#include "Evaluator.h"
+#include "GameCore.h"
+#include "MoveGenerator.h"
+#include "Pieces.h"
+#include "Placement.h"
+#include "Random.h"
+#include "Zobrist.h"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <vector>
+
+namespace
+{
+	const int kW = Board::kBoardWidth;
+	const int kH = Board::kBoardHeight;
+	const int kQueriesPerBoard = 8;				// Random pieces checked on every board
+	const int kMaxReported = 10;				// Mismatches printed before the rest are only counted
+	const int kFootprintOffset = 16;			// Footprints keep the blocks out of the board positive
+
+	// Blocks of a board, true = filled
+	struct Cells
+	{
+		bool filled[kH][kW];
+	};
+
+	// Blocks filled by a piece at a position, sorted, so two positions filling the same blocks compare equal
+	typedef std::array<int, Pieces::kPieceCells> Footprint;
+
+	struct State
+	{
+		int x, y, rotation;
+	};
+
+	int64_t checks = 0;
+	int64_t failures = 0;
+
+	void Check(bool ok, const char* what, int board)
+	{
+		checks++;
+		if (ok)
+			return;
+
+		if (failures < kMaxReported)
+			printf("Mismatch on board %d: %s\n", board, what);
+		failures++;
+	}
+
+	Cells GetCells(const Board& board)
+	{
+		Cells cells;
+		for (int y = 0; y < kH; y++)
+			for (int x = 0; x < kW; x++)
+				cells.filled[y][x] = !board.IsFreeBlock(x, y);
+		return cells;
+	}
+
+	bool SameCells(const Cells& a, const Cells& b)
+	{
+		return memcmp(a.filled, b.filled, sizeof(a.filled)) == 0;
+	}
+
+	// Every block of the 5x5 matrix of the piece, as the original Board::IsPossibleMovement did it
+	bool NaiveFits(const Cells& cells, int x, int y, int piece, int rotation)
+	{
+		for (int i = 0; i < Pieces::kPieceBlocks; i++)
+		{
+			for (int j = 0; j < Pieces::kPieceBlocks; j++)
+			{
+				if (Pieces::GetBlockType(piece, rotation, j, i) == 0)
+					continue;
+
+				int bx = x + i;
+				int by = y + j;
+				if (bx < 0 || bx >= kW || by >= kH)
+					return false;
+				if (by >= 0 && cells.filled[by][bx])
+					return false;
+			}
+		}
+		return true;
+	}
+
+	int NaiveDrop(const Cells& cells, int x, int y, int piece, int rotation)
+	{
+		while (NaiveFits(cells, x, y + 1, piece, rotation))
+			y++;
+		return y;
+	}
+
+	Footprint GetFootprint(int x, int y, int piece, int rotation)
+	{
+		Footprint footprint;
+		int n = 0;
+		for (int j = 0; j < Pieces::kPieceBlocks; j++)
+			for (int i = 0; i < Pieces::kPieceBlocks; i++)
+				if (Pieces::GetBlockType(piece, rotation, j, i) != 0)
+					footprint[n++] = (y + j + kFootprintOffset) * 64 + (x + i + kFootprintOffset);
+		return footprint;						// Rows then columns, already sorted
+	}
+
+	// Store the piece in the cells and delete the full lines, returns the number of lines deleted
+	int NaiveStore(Cells* cells, int x, int y, int piece, int rotation)
+	{
+		for (int cell : GetFootprint(x, y, piece, rotation))
+		{
+			int by = cell / 64 - kFootprintOffset;
+			if (by >= 0)
+				cells->filled[by][cell % 64 - kFootprintOffset] = true;
+		}
+
+		Cells kept = {};
+		int dest = kH - 1;
+		int deleted = 0;
+		for (int y = kH - 1; y >= 0; y--)
+		{
+			bool full = true;
+			for (int x = 0; x < kW; x++)
+				full = full && cells->filled[y][x];
+
+			if (full)
+				deleted++;
+			else
+				memcpy(kept.filled[dest--], cells->filled[y], sizeof(kept.filled[y]));
+		}
+		*cells = kept;
+		return deleted;
+	}
+
+	int NaiveHeight(const Cells& cells, int x)
+	{
+		for (int y = 0; y < kH; y++)
+			if (cells.filled[y][x])
+				return kH - y;
+		return 0;
+	}
+
+	uint64_t NaiveHash(const Cells& cells)
+	{
+		uint64_t hash = 0;
+		for (int y = 0; y < kH; y++)
+			for (int x = 0; x < kW; x++)
+				if (cells.filled[y][x])
+					hash ^= Zobrist::CellKey(x, y);
+		return hash;
+	}
+
+	// Features of Evaluator::GetFeatures, block by block
+	Evaluator::Features NaiveFeatures(const Cells& cells, int lines)
+	{
+		Evaluator::Features features = {};
+		features.lines = lines;
+
+		auto filled = [&](int x, int y) { return x < 0 || x >= kW || cells.filled[y][x]; };	// The walls are filled
+
+		for (int x = 0; x < kW; x++)
+		{
+			int height = NaiveHeight(cells, x);
+			features.height += height;
+			if (height > features.max_height)
+				features.max_height = height;
+			if (x + 1 < kW)
+				features.bumpiness += abs(height - NaiveHeight(cells, x + 1));
+
+			// Nothing above the board, the floor is filled
+			bool above = false;
+			bool covered = false;
+			int depth = 0;
+			for (int y = 0; y < kH; y++)
+			{
+				bool block = cells.filled[y][x];
+				covered = covered || block;
+
+				if (covered && !block)
+					features.holes++;
+				if (block != above)
+					features.column_transitions++;
+				above = block;
+
+				if (!covered && filled(x - 1, y) && filled(x + 1, y))
+					features.wells += ++depth;
+				else
+					depth = 0;
+			}
+			if (!above)
+				features.column_transitions++;
+		}
+
+		for (int y = 0; y < kH; y++)
+			for (int x = -1; x < kW; x++)
+				if (filled(x, y) != filled(x + 1, y))
+					features.row_transitions++;
+
+		return features;
+	}
+
+	/*
+	======================================
+	Every position where the piece can be locked, by a breadth first search over the positions
+	with the moves of GameCore, one at a time. Returns the footprints of the positions
+	======================================
+	*/
+	std::set<Footprint> NaiveMoves(const Cells& cells, int piece, State start)
+	{
+		const int kMinX = -Pieces::kPieceBlocks;
+		const int kMinY = -Placement::kTopLines;
+		const int kSpanX = kW + 2 * Pieces::kPieceBlocks;
+		const int kSpanY = kH + Placement::kTopLines;
+
+		std::vector<bool> visited((size_t) kSpanX * kSpanY * Pieces::kRotations, false);
+		auto index = [&](const State& s) { return ((size_t) s.rotation * kSpanY + (s.y - kMinY)) * kSpanX + (s.x - kMinX); };
+
+		std::set<Footprint> moves;
+		std::vector<State> queue(1, start);
+		visited[index(start)] = true;
+
+		for (size_t head = 0; head < queue.size(); head++)
+		{
+			State s = queue[head];
+			if (!NaiveFits(cells, s.x, s.y + 1, piece, s.rotation))
+				moves.insert(GetFootprint(s.x, s.y, piece, s.rotation));
+
+			const State neighbours[] =
+			{
+				{ s.x - 1, s.y, s.rotation },
+				{ s.x + 1, s.y, s.rotation },
+				{ s.x, s.y + 1, s.rotation },
+				{ s.x, s.y, (s.rotation + 1) % Pieces::kRotations }
+			};
+			for (const State& next : neighbours)
+			{
+				if (!NaiveFits(cells, next.x, next.y, piece, next.rotation) || visited[index(next)])
+					continue;
+				visited[index(next)] = true;
+				queue.push_back(next);
+			}
+		}
+
+		return moves;
+	}
+
+	// Apply the inputs of a path one by one, every one of them has to move the piece
+	bool ReplayPath(const Cells& cells, int piece, State* s, const GameCore::Input* inputs, int length)
+	{
+		for (int i = 0; i < length; i++)
+		{
+			State next = *s;
+			switch (inputs[i])
+			{
+			case GameCore::eInputLeft:		next.x--;		break;
+			case GameCore::eInputRight:		next.x++;		break;
+			case GameCore::eInputDown:		next.y++;		break;
+			case GameCore::eInputRotate:	next.rotation = (next.rotation + 1) % Pieces::kRotations;	break;
+			default:						return false;
+			}
+
+			if (!NaiveFits(cells, next.x, next.y, piece, next.rotation))
+				return false;
+			*s = next;
+		}
+		return true;
+	}
+
+	/*
+	======================================
+	Random boards: snapshots of random games, and boards with random pieces stored anywhere they
+	fit (not dropped), which have more overhangs, holes and wells than real games
+	======================================
+	*/
+	std::vector<Board> BuildBoards(int count, Random* random)
+	{
+		std::vector<Board> boards;
+
+		for (int game = 0; (int) boards.size() < count / 2; game++)
+		{
+			GameCore core(random->NextU64());
+			while (!core.IsGameOver() && (int) boards.size() < count / 2)
+			{
+				int rotations = random->NextInt(Pieces::kRotations);
+				int moves = random->NextInt(6);
+				int direction = random->NextInt(2) == 0 ? GameCore::eInputLeft : GameCore::eInputRight;
+				for (int i = 0; i < rotations; i++)
+					core.Step(GameCore::eInputRotate, 0);
+				for (int i = 0; i < moves; i++)
+					core.Step(direction, 0);
+				core.Step(GameCore::eInputDrop, 0);
+
+				boards.push_back(core.GetBoard());
+			}
+		}
+
+		while ((int) boards.size() < count)
+		{
+			Board board;
+			int pieces = random->NextInt(40);
+			for (int i = 0; i < pieces; i++)
+			{
+				int piece = random->NextInt(Pieces::kPieceKinds);
+				int rotation = random->NextInt(Pieces::kRotations);
+				int x = random->NextInt(kW + 2) - 2;
+				int y = random->NextInt(kH) - 1;
+				if (board.IsPossibleMovement(x, y, piece, rotation))
+				{
+					board.StorePiece(x, y, piece, rotation);
+					board.DeletePossibleLines();
+				}
+			}
+			boards.push_back(board);
+		}
+
+		return boards;
+	}
+
+	// IsPossibleMovement, GetDropPosition, StorePiece, DeletePossibleLines and Unmake
+	void CheckBoard(const Board& board, int index, Random* random)
+	{
+		Cells cells = GetCells(board);
+
+		for (int x = 0; x < kW; x++)
+			Check(board.GetColumnHeight(x) == NaiveHeight(cells, x), "GetColumnHeight", index);
+		Check(board.GetHash() == NaiveHash(cells), "GetHash", index);
+
+		for (int q = 0; q < kQueriesPerBoard; q++)
+		{
+			int piece = random->NextInt(Pieces::kPieceKinds);
+			int rotation = random->NextInt(Pieces::kRotations);
+			int x = random->NextInt(kW + 4) - 3;
+			int y = random->NextInt(kH + 4) - 4;
+
+			bool fits = NaiveFits(cells, x, y, piece, rotation);
+			Check(board.IsPossibleMovement(x, y, piece, rotation) == fits, "IsPossibleMovement", index);
+			if (!fits)
+				continue;
+
+			int drop = NaiveDrop(cells, x, y, piece, rotation);
+			Check(board.GetDropPosition(x, y, piece, rotation) == drop, "GetDropPosition", index);
+
+			// Lock it there, then take it out again
+			Board after = board;
+			Board::Undo undo;
+			after.StorePiece(x, drop, piece, rotation, &undo);
+			int lines = after.DeletePossibleLines(&undo.cleared_rows);
+
+			Cells expected = cells;
+			int expected_lines = NaiveStore(&expected, x, drop, piece, rotation);
+			Check(lines == expected_lines && SameCells(GetCells(after), expected), "StorePiece and DeletePossibleLines", index);
+			Check(after.GetHash() == NaiveHash(expected), "GetHash after DeletePossibleLines", index);
+			for (int i = 0; i < kW; i++)
+				Check(after.GetColumnHeight(i) == NaiveHeight(expected, i), "GetColumnHeight after DeletePossibleLines", index);
+
+			after.Unmake(undo);
+			bool restored = SameCells(GetCells(after), cells) && after.GetHash() == board.GetHash();
+			for (int i = 0; i < kW; i++)
+				restored = restored && after.GetColumnHeight(i) == board.GetColumnHeight(i);
+			Check(restored, "Unmake", index);
+		}
+
+		// Every lane and rotation at once
+		int piece = random->NextInt(Pieces::kPieceKinds);
+		int y = random->NextInt(Placement::kTopLines + 4) - Placement::kTopLines;
+		Placement::Result result;
+		Placement::Evaluate(board, piece, y, &result);
+		for (int rotation = 0; rotation < Pieces::kRotations; rotation++)
+		{
+			for (int lane = 0; lane < Placement::kLanes; lane++)
+			{
+				int x = Placement::kFirstX + lane;
+				bool fits = NaiveFits(cells, x, y, piece, rotation);
+				bool valid = (result.valid[rotation] >> lane) & 1;
+				Check(valid == fits, "Placement::Evaluate valid lanes", index);
+				if (valid && fits)
+					Check(result.landing[rotation][lane] == NaiveDrop(cells, x, y, piece, rotation), "Placement::Evaluate landing", index);
+			}
+		}
+	}
+
+	// The moves of MoveGenerator are the naive ones, once each, and GetPath reaches every one of them
+	void CheckMoves(const Board& board, int index, MoveGenerator* generator, Random* random)
+	{
+		Cells cells = GetCells(board);
+		int piece = random->NextInt(Pieces::kPieceKinds);
+
+		// From where the piece appears, and from a random position where it fits
+		State starts[2];
+		starts[0].rotation = random->NextInt(Pieces::kRotations);
+		starts[0].x = kW / 2 + Pieces::GetXInitialPosition(piece, starts[0].rotation);
+		starts[0].y = Pieces::GetYInitialPosition(piece, starts[0].rotation);
+		starts[1] = starts[0];
+		for (int tries = 0; tries < 20; tries++)
+		{
+			State s = { random->NextInt(kW + 2) - 2, random->NextInt(kH + 3) - 3, random->NextInt(Pieces::kRotations) };
+			if (NaiveFits(cells, s.x, s.y, piece, s.rotation))
+			{
+				starts[1] = s;
+				break;
+			}
+		}
+
+		for (const State& start : starts)
+		{
+			if (!NaiveFits(cells, start.x, start.y, piece, start.rotation))
+				continue;
+
+			int count = generator->Generate(board, piece, start.x, start.y, start.rotation);
+
+			std::set<Footprint> found;
+			for (int i = 0; i < count; i++)
+			{
+				const MoveGenerator::Move& move = generator->GetMove(i);
+				found.insert(GetFootprint(move.x, move.y, piece, move.rotation));
+
+				GameCore::Input path[MoveGenerator::kStates];
+				int length = generator->GetPath(i, path, MoveGenerator::kStates);
+
+				State s = start;
+				bool reached = length >= 0 && ReplayPath(cells, piece, &s, path, length) &&
+					s.x == move.x && s.y == move.y && s.rotation == move.rotation;
+				Check(reached, "MoveGenerator::GetPath", index);
+			}
+
+			Check((int) found.size() == count, "MoveGenerator::Generate duplicates", index);
+			Check(found == NaiveMoves(cells, piece, start), "MoveGenerator::Generate moves", index);
+		}
+	}
+
+	void CheckFeatures(const Board& board, int index, Random* random)
+	{
+		int lines = random->NextInt(100);
+
+		Evaluator::Features features;
+		Evaluator::GetFeatures(board, lines, &features);
+		Evaluator::Features expected = NaiveFeatures(GetCells(board), lines);
+
+		Check(features.height == expected.height, "Evaluator height", index);
+		Check(features.max_height == expected.max_height, "Evaluator max_height", index);
+		Check(features.holes == expected.holes, "Evaluator holes", index);
+		Check(features.row_transitions == expected.row_transitions, "Evaluator row_transitions", index);
+		Check(features.column_transitions == expected.column_transitions, "Evaluator column_transitions", index);
+		Check(features.wells == expected.wells, "Evaluator wells", index);
+		Check(features.bumpiness == expected.bumpiness, "Evaluator bumpiness", index);
+		Check(features.lines == expected.lines, "Evaluator lines", index);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int board_count = 2000;
+	uint64_t seed = 1;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--boards") == 0)		board_count = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--seed") == 0)	seed = strtoull(argv[i + 1], nullptr, 10);
+		else
+		{
+			fprintf(stderr, "Unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+
+	Random random(seed);
+	std::vector<Board> boards = BuildBoards(board_count, &random);
+
+	MoveGenerator generator;
+	for (int i = 0; i < (int) boards.size(); i++)
+	{
+		CheckBoard(boards[i], i, &random);
+		CheckMoves(boards[i], i, &generator, &random);
+		CheckFeatures(boards[i], i, &random);
+	}
+
+	printf("%d boards, %lld checks, %lld mismatches (%s)\n", (int) boards.size(), (long long) checks, (long long) failures,
+		Placement::GetInstructionSet());
+	return failures == 0 ? 0 : 1;
+}
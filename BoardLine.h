@@ -0,0 +1,187 @@
+/*****************************************************************************************
+/* File: BoardLine.h
+/* Desc: Occupancy mask of one line of a board (bit x = column x). The storage is chosen at
+/*       compile time from the width of the board: the smallest integer that holds it, or
+/*       several 64 bit words for boards wider than 64 columns
+/*****************************************************************************************/
+
+#ifndef _BOARD_LINE_
+#define _BOARD_LINE_
+
+#include "Bits.h"
+#include "Zobrist.h"
+#include <cstdint>
+#include <type_traits>
+
+// Operations on a line stored in one integer
+template <int W, typename Word>
+struct IntLineTraits
+{
+	typedef Word Line;
+
+	static Line Zero()
+	{
+		return 0;
+	}
+
+	static Line Full()
+	{
+		return (Line) ((Word) ~Word(0) >> (sizeof(Word) * 8 - W));		// Cast back, ~ promotes the small words to int
+	}
+
+	// Line with the blocks of a line of a piece (bit i = column shift + i)
+	static Line Piece(unsigned int bits, int shift)
+	{
+		return (Line) ((Line) bits << shift);
+	}
+
+	static bool Any(Line line)
+	{
+		return line != 0;
+	}
+
+	static bool Test(Line line, int x)
+	{
+		return ((line >> x) & 1) != 0;
+	}
+
+	template <typename F>
+	static void ForEachBit(Line line, F f)
+	{
+		for (uint64_t bits = line; bits != 0; bits &= bits - 1)
+			f(Bits::CountTrailingZeros(bits));
+	}
+
+	// XOR of the Zobrist keys of the blocks of line y
+	static uint64_t Key(int y, Line line)
+	{
+		if (W <= Zobrist::kMaxColumns)
+			return Zobrist::GetLineKey(y, (unsigned int) line);
+
+		uint64_t key = 0;
+		IntLineTraits::ForEachBit(line, [&](int x) { key ^= Zobrist::CellKey(x, y); });
+		return key;
+	}
+};
+
+template <int N>
+struct WideLine
+{
+	uint64_t words[N];
+
+	WideLine operator& (const WideLine& other) const
+	{
+		WideLine result;
+		for (int i = 0; i < N; i++)
+			result.words[i] = this->words[i] & other.words[i];
+		return result;
+	}
+
+	WideLine operator^ (const WideLine& other) const
+	{
+		WideLine result;
+		for (int i = 0; i < N; i++)
+			result.words[i] = this->words[i] ^ other.words[i];
+		return result;
+	}
+
+	WideLine& operator|= (const WideLine& other)
+	{
+		for (int i = 0; i < N; i++)
+			this->words[i] |= other.words[i];
+		return *this;
+	}
+
+	WideLine& operator^= (const WideLine& other)
+	{
+		for (int i = 0; i < N; i++)
+			this->words[i] ^= other.words[i];
+		return *this;
+	}
+
+	bool operator== (const WideLine& other) const
+	{
+		for (int i = 0; i < N; i++)
+			if (this->words[i] != other.words[i])
+				return false;
+		return true;
+	}
+
+	bool operator!= (const WideLine& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+// Operations on a line stored in several 64 bit words (word i holds the columns 64 * i..)
+template <int W>
+struct WideLineTraits
+{
+	static const int kWords = (W + 63) / 64;
+
+	typedef WideLine<kWords> Line;
+
+	static Line Zero()
+	{
+		return Line{};
+	}
+
+	static Line Full()
+	{
+		Line line;
+		for (int i = 0; i < kWords; i++)
+			line.words[i] = ~0ull;
+		if (W % 64 != 0)
+			line.words[kWords - 1] = ~0ull >> (64 - W % 64);
+		return line;
+	}
+
+	static Line Piece(unsigned int bits, int shift)
+	{
+		Line line = Zero();
+		int word = shift / 64;
+		int offset = shift % 64;
+
+		line.words[word] = (uint64_t) bits << offset;
+		if (offset != 0 && word + 1 < kWords)
+			line.words[word + 1] = (uint64_t) bits >> (64 - offset);
+		return line;
+	}
+
+	static bool Any(const Line& line)
+	{
+		uint64_t any = 0;
+		for (int i = 0; i < kWords; i++)
+			any |= line.words[i];
+		return any != 0;
+	}
+
+	static bool Test(const Line& line, int x)
+	{
+		return ((line.words[x / 64] >> (x % 64)) & 1) != 0;
+	}
+
+	template <typename F>
+	static void ForEachBit(const Line& line, F f)
+	{
+		for (int i = 0; i < kWords; i++)
+			for (uint64_t bits = line.words[i]; bits != 0; bits &= bits - 1)
+				f(i * 64 + Bits::CountTrailingZeros(bits));
+	}
+
+	static uint64_t Key(int y, const Line& line)
+	{
+		uint64_t key = 0;
+		WideLineTraits::ForEachBit(line, [&](int x) { key ^= Zobrist::CellKey(x, y); });
+		return key;
+	}
+};
+
+template <int W>
+using LineTraits =
+	typename std::conditional<(W <= 16), IntLineTraits<W, uint16_t>,
+	typename std::conditional<(W <= 32), IntLineTraits<W, uint32_t>,
+	typename std::conditional<(W <= 64), IntLineTraits<W, uint64_t>,
+	WideLineTraits<W>>::type>::type>::type;
+
+#endif // _BOARD_LINE_
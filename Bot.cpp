@@ -0,0 +1,621 @@
+/*****************************************************************************************
+/* File: Bot.cpp
+/* Desc: Player that chooses where to lock every piece with a beam search over the current
+/*       piece and the upcoming pieces of the queue, or an expectimax search that averages
+/*       over the pieces the randomizer can deal after them
+/*****************************************************************************************/
+
+#include "Bot.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	const double kGameOverScore = -1e9;
+	const int kMaxOutcomes = Pieces::kPieceKinds * Pieces::kRotations;
+
+	// Piece that can be dealt at a chance node of the expectimax
+	struct Outcome
+	{
+		int piece;
+		int rotation;
+		double odds;
+		uint64_t state;							// State of the randomizer once the piece is dealt
+	};
+
+	// The piece gives the same moves when it appears with both rotations: it has the same blocks and
+	// the same position with them, and after every number of rotations
+	bool IsSameSpawn(int piece, int rotation_a, int rotation_b)
+	{
+		for (int turns = 0; turns < Pieces::kRotations; turns++)
+		{
+			int a = (rotation_a + turns) % Pieces::kRotations;
+			int b = (rotation_b + turns) % Pieces::kRotations;
+
+			if (Pieces::GetXInitialPosition(piece, a) != Pieces::GetXInitialPosition(piece, b) ||
+				Pieces::GetYInitialPosition(piece, a) != Pieces::GetYInitialPosition(piece, b))
+				return false;
+
+			for (int y = 0; y < Pieces::kPieceBlocks; y++)
+				for (int x = 0; x < Pieces::kPieceBlocks; x++)
+					if ((Pieces::GetBlockType(piece, a, x, y) != 0) != (Pieces::GetBlockType(piece, b, x, y) != 0))
+						return false;
+		}
+		return true;
+	}
+}
+
+Bot::Bot()
+	: Bot(Settings())
+{
+}
+
+Bot::Bot(const Settings& settings)
+	: settings_(settings), evaluator_(settings.weights), table_(settings.table_megabytes), pool_(settings.pool != nullptr ? *settings.pool : ThreadPool::GetGlobal())
+{
+	int workers = settings.single_thread ? 1 : this->pool_.GetWorkerCount();
+	for (int worker = 0; worker < workers; worker++)
+		this->workers_.push_back(std::make_unique<Worker>());
+
+	// Every spawn rotation is counted with the first one that gives the same moves
+	for (int piece = 0; piece < Pieces::kPieceKinds; piece++)
+	{
+		for (int rotation = 0; rotation < Pieces::kRotations; rotation++)
+		{
+			this->spawns_[piece][rotation] = 0;
+
+			int first = 0;
+			while (!IsSameSpawn(piece, first, rotation))
+				first++;
+			this->spawns_[piece][first]++;
+		}
+	}
+}
+
+/* 
+======================================									
+Choose where to lock the current piece with the search of the settings
+
+Parameters:
+
+>> core:		Game to play
+>> decision:	Receives the move and the inputs to reach it
+
+Returns false if the game is over.
+====================================== 
+*/
+bool Bot::Think(const GameCore& core, Decision* decision)
+{
+	if (core.IsGameOver())
+		return false;
+
+	this->deadline_ = Clock::now() + std::chrono::microseconds(this->settings_.time_budget_us);
+	this->table_.NewSearch();
+
+	// First level: every move of the current piece
+	int piece = core.GetPiece();
+	int count = this->root_generator_.Generate(core.GetBoard(), piece, core.GetPosX(), core.GetPosY(), core.GetRotation());
+	if (count == 0)
+		return false;
+
+	this->beam_.clear();
+	for (int i = 0; i < count; i++)
+	{
+		const MoveGenerator::Move& move = this->root_generator_.GetMove(i);
+
+		Node node;
+		node.board = core.GetBoard();
+		node.board.StorePiece(move.x, move.y, piece, move.rotation);
+		node.lines = node.board.DeletePossibleLines();
+		node.root = i;
+		node.score = node.board.IsGameOver() ? kGameOverScore : this->evaluator_.Evaluate(node.board, node.lines);
+		this->beam_.push_back(node);
+	}
+
+	int best;
+	if (this->settings_.search == Bot::eSearchExpectimax)
+		best = this->SearchExpectimax(core, &decision->depth);
+	else
+		best = this->SearchBeam(core, &decision->depth);
+
+	decision->move = this->root_generator_.GetMove(best);
+	decision->path_length = this->root_generator_.GetPath(best, decision->path, Bot::kMaxPath);
+
+	return decision->path_length >= 0;
+}
+
+/* 
+======================================									
+Choose where to lock the current piece, move it there and drop it
+
+Parameters:
+
+>> core:	Game to play, the piece is moved with Step like a player would
+
+Returns false if the game is over.
+====================================== 
+*/
+bool Bot::Play(GameCore& core)
+{
+	Decision decision;
+	if (!this->Think(core, &decision))
+		return false;
+
+	Bot::Apply(decision, core);
+	return true;
+}
+
+/* 
+======================================									
+Move the piece to the move of a decision and drop it, on the game the decision was taken for
+
+Parameters:
+
+>> decision:	Filled by Think
+>> core:		Game to play, in the same state as when Think was called
+====================================== 
+*/
+void Bot::Apply(const Decision& decision, GameCore& core)
+{
+	for (int i = 0; i < decision.path_length; i++)
+		core.Step(decision.path[i], 0);
+	core.Step(GameCore::eInputDrop, 0);
+}
+
+/* 
+======================================									
+Beam search: every level places one more piece (the current one, then the pieces of the queue)
+on every board of the beam, and keeps the best beam_width boards. The boards of a level are
+expanded in parallel. The move chosen is the move of the current piece that leads to the best
+board of the deepest level reached in time. A single_thread bot expands them on the calling thread
+
+Parameters:
+
+>> core:	Game to play, the beam holds the moves of the current piece
+>> depth:	Receives the number of levels completed
+
+Returns the index of the move chosen.
+====================================== 
+*/
+int Bot::SearchBeam(const GameCore& core, int* depth)
+{
+	this->KeepBest(&this->beam_, 0, core.GetQueue());
+	*depth = 1;
+
+	// Next levels: the pieces of the queue
+	int levels = std::min(this->settings_.depth, std::min(this->settings_.preview, PieceQueue::kLookahead) + 1);
+	for (int level = 1; level < levels; level++)
+	{
+		if (this->settings_.time_budget_us > 0 && Clock::now() >= this->deadline_)
+			break;
+
+		PieceQueue::Entry next = core.GetQueue().Peek(level - 1);
+
+		this->children_.resize(this->beam_.size());
+		auto expand = [&](int worker, int index) {
+			this->Expand(this->beam_[index], next.piece, next.rotation, &this->workers_[worker]->generator, &this->children_[index]);
+		};
+
+		if (this->settings_.single_thread)
+		{
+			for (int i = 0; i < (int) this->beam_.size(); i++)
+				expand(0, i);
+		}
+		else
+			this->pool_.ParallelFor((int) this->beam_.size(), expand);
+
+		this->level_.clear();
+		for (int i = 0; i < (int) this->beam_.size(); i++)
+			this->level_.insert(this->level_.end(), this->children_[i].begin(), this->children_[i].end());
+
+		this->KeepBest(&this->level_, level, core.GetQueue());
+		this->beam_.swap(this->level_);
+		*depth = level + 1;
+	}
+
+	return this->beam_[0].root;
+}
+
+/* 
+======================================									
+Place a piece on the board of a node in every possible way
+
+Parameters:
+
+>> node:		Node to expand
+>> piece:		Piece to place, it appears where GameCore creates the pieces
+>> rotation:	Rotation of the piece when it appears
+>> generator:	Move generator of the worker
+>> children:	Receives the nodes of every move. A node where the game is over is its own child
+====================================== 
+*/
+void Bot::Expand(const Node& node, int piece, int rotation, MoveGenerator* generator, std::vector<Node>* children)
+{
+	children->clear();
+
+	int x = (Board::kBoardWidth / 2) + Pieces::GetXInitialPosition(piece, rotation);
+	int y = Pieces::GetYInitialPosition(piece, rotation);
+	int count = node.score == kGameOverScore ? 0 : generator->Generate(node.board, piece, x, y, rotation);
+
+	if (count == 0)
+	{
+		children->push_back(node);
+		children->back().score = kGameOverScore;
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		const MoveGenerator::Move& move = generator->GetMove(i);
+
+		Node child;
+		child.board = node.board;
+		child.board.StorePiece(move.x, move.y, piece, move.rotation);
+		child.lines = node.lines + child.board.DeletePossibleLines();
+		child.root = node.root;
+		child.score = child.board.IsGameOver() ? kGameOverScore : this->evaluator_.Evaluate(child.board, child.lines);
+		children->push_back(child);
+	}
+}
+
+/* 
+======================================									
+Keep the beam_width nodes with the best score, best first. A board reached by several sequences
+of moves is kept once, with its best score: the boards kept are marked in the transposition
+table, keyed by the board and the pieces left in the queue. Equal scores are ordered by move so
+the choice doesn't depend on the threads
+
+Parameters:
+
+>> nodes:	Nodes of a level of the search
+>> level:	Level of the search, the pieces of the queue from this one are still to be placed
+>> queue:	Queue of the game
+====================================== 
+*/
+void Bot::KeepBest(std::vector<Node>* nodes, int level, const PieceQueue& queue)
+{
+	// The nodes are big, their indices are sorted
+	std::vector<int>& order = this->order_;
+	order.resize(nodes->size());
+	for (int i = 0; i < (int) order.size(); i++)
+		order[i] = i;
+
+	auto better = [nodes](int a, int b) {
+		const Node& node_a = (*nodes)[a];
+		const Node& node_b = (*nodes)[b];
+		return node_a.score != node_b.score ? node_a.score > node_b.score : node_a.root < node_b.root;
+	};
+
+	// Few boards are duplicates: only the first ones are sorted, the others if they run out
+	int sorted = std::min((int) order.size(), 2 * this->settings_.beam_width);
+	std::partial_sort(order.begin(), order.begin() + sorted, order.end(), better);
+
+	uint64_t queue_hash = 0;
+	for (int i = level; i < PieceQueue::kLookahead; i++)
+		queue_hash ^= Zobrist::GetQueueKey(i - level, queue.Peek(i).piece);
+
+	std::vector<Node>& best = this->best_;
+	best.clear();
+	for (int i = 0; i < (int) order.size() && (int) best.size() < this->settings_.beam_width; i++)
+	{
+		if (i == sorted)
+		{
+			std::sort(order.begin() + sorted, order.end(), better);
+			sorted = (int) order.size();
+		}
+
+		const Node& node = (*nodes)[order[i]];
+		uint64_t key = node.board.GetHash() ^ queue_hash;
+
+		TranspositionTable::Entry entry;
+		if (this->table_.Probe(key, &entry) && entry.age == this->table_.GetAge() && entry.depth == level)
+			continue;
+
+		this->table_.Store(key, (float) node.score, level);
+		best.push_back(node);
+	}
+	nodes->swap(best);
+}
+
+/* 
+======================================									
+Expectimax search. The pieces known (the current one and the preview) are max nodes: the best
+move of the piece is played. After them, every level is a chance node: the next piece is one the
+randomizer of the game can deal after the pieces before it (a bag only deals the pieces left in
+it), with one of the rotations, and its value is the average weighted by the odds of the pieces.
+Only the branch_width moves with the best evaluations are searched further.
+
+A chance node stops early when the pieces left can't bring its average over the best value
+already found by its parent, even with the highest score of the evaluator (Star1 pruning). The
+values of the chance nodes are kept in the transposition table: they depend only on the board,
+the state of the randomizer and the pieces left to place, they are found again from one move to
+the next.
+
+The search is run deeper and deeper while there is time. The pieces of the first chance node of
+every branch are searched in parallel, unless the bot is single_thread.
+
+Parameters:
+
+>> core:	Game to play, the beam holds the moves of the current piece
+>> depth:	Receives the depth of the deepest search completed
+
+Returns the index of the move chosen.
+====================================== 
+*/
+int Bot::SearchExpectimax(const GameCore& core, int* depth)
+{
+	std::sort(this->beam_.begin(), this->beam_.end(), [](const Node& a, const Node& b) {
+		return a.score != b.score ? a.score > b.score : a.root < b.root;
+	});
+
+	int max_depth = std::min(this->settings_.depth, Bot::kMaxDepth);
+	this->known_count_ = std::min(1 + std::min(this->settings_.preview, PieceQueue::kLookahead), max_depth);
+	this->known_[0].piece = core.GetPiece();
+	this->known_[0].rotation = core.GetRotation();
+	for (int level = 1; level < this->known_count_; level++)
+		this->known_[level] = core.GetQueue().Peek(level - 1);
+	this->randomizer_ = &core.GetQueue().GetRandomizer();
+	this->unknown_state_ = core.GetQueue().GetRandomizerState(this->known_count_ - 1);
+	this->stopped_ = false;
+
+	// Depth 1: the best board after the current piece
+	int best = this->beam_[0].root;
+	*depth = 1;
+
+	bool parallel = !this->settings_.single_thread;
+	int worker = parallel ? this->pool_.GetCurrentWorker() : 0;
+	int width = std::min((int) this->beam_.size(), this->settings_.branch_width);
+	for (int iteration = 2; iteration <= max_depth; iteration++)
+	{
+		this->search_depth_ = iteration;
+
+		double best_value = -std::numeric_limits<double>::infinity();
+		int best_root = -1;
+		for (int i = 0; i < width && !this->IsStopped(); i++)
+		{
+			const Node& node = this->beam_[i];
+
+			bool exact;
+			double value = node.board.IsGameOver() ? kGameOverScore : this->SearchLevel(node.board, node.lines, 1, this->unknown_state_, best_value, worker, parallel, &exact);
+			if (best_root < 0 || value > best_value)
+			{
+				best_value = value;
+				best_root = node.root;
+			}
+		}
+
+		if (this->IsStopped())
+			break;
+
+		best = best_root;
+		*depth = iteration;
+	}
+
+	return best;
+}
+
+// Value of a board of the expectimax, with the piece of a level still to place
+double Bot::SearchLevel(const Board& board, int lines, int level, uint64_t state, double alpha, int worker, bool parallel, bool* exact)
+{
+	if (level < this->known_count_)
+		return this->MaxNode(board, lines, level, this->known_[level].piece, this->known_[level].rotation, state, alpha, worker, parallel, exact);
+
+	return this->ChanceNode(board, lines, level, state, alpha, worker, parallel, exact);
+}
+
+/* 
+======================================									
+Value of a board of the expectimax where a piece is placed: the value of its best move
+
+Parameters:
+
+>> board:		Board of the node
+>> lines:		Lines cleared to reach the board
+>> level:		Level of the piece in the search
+>> piece:		Piece to place, it appears where GameCore creates the pieces
+>> rotation:	Rotation of the piece when it appears
+>> state:		State of the randomizer once the piece is dealt
+>> alpha:		Value that the node has to beat to matter to its parent
+>> worker:		Worker of the pool running the search
+>> parallel:	The next chance node can run its pieces in parallel
+>> exact:		Receives false if the value is only an upper bound, at most alpha
+
+Returns the value of the board.
+====================================== 
+*/
+double Bot::MaxNode(const Board& board, int lines, int level, int piece, int rotation, uint64_t state, double alpha, int worker, bool parallel, bool* exact)
+{
+	*exact = false;
+	if (this->IsStopped())
+		return alpha;
+
+	Worker& memory = *this->workers_[worker];
+
+	int x = (Board::kBoardWidth / 2) + Pieces::GetXInitialPosition(piece, rotation);
+	int y = Pieces::GetYInitialPosition(piece, rotation);
+	int count = memory.generator.Generate(board, piece, x, y, rotation);
+
+	*exact = true;
+	if (count == 0)
+		return kGameOverScore;
+
+	// Every move is made on one copy of the board and unmade once evaluated. The moves are copied,
+	// the generator of the worker is used again down the search
+	Board after = board;
+	Board::Undo undo;
+	std::vector<Candidate>& candidates = memory.candidates[level];
+	candidates.clear();
+	for (int i = 0; i < count; i++)
+	{
+		Candidate candidate;
+		candidate.move = memory.generator.GetMove(i);
+		candidate.index = i;
+
+		after.StorePiece(candidate.move.x, candidate.move.y, piece, candidate.move.rotation, &undo);
+		candidate.lines = lines + after.DeletePossibleLines(&undo.cleared_rows);
+		candidate.score = after.IsGameOver() ? kGameOverScore : this->evaluator_.Evaluate(after, candidate.lines);
+		after.Unmake(undo);
+
+		candidates.push_back(candidate);
+	}
+
+	// Last level: the best evaluation
+	if (level == this->search_depth_ - 1)
+	{
+		double best = kGameOverScore;
+		for (const Candidate& candidate : candidates)
+			best = std::max(best, candidate.score);
+		return best;
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+		return a.score != b.score ? a.score > b.score : a.index < b.index;
+	});
+
+	double best = -std::numeric_limits<double>::infinity();
+	int width = std::min(count, this->settings_.branch_width);
+	for (int i = 0; i < width; i++)
+	{
+		const Candidate& candidate = candidates[i];
+		if (candidate.score == kGameOverScore)
+		{
+			best = std::max(best, kGameOverScore);
+			continue;
+		}
+
+		// Only the moves searched further are made again, the board is restored before the next one
+		after.StorePiece(candidate.move.x, candidate.move.y, piece, candidate.move.rotation, &undo);
+		after.DeletePossibleLines(&undo.cleared_rows);
+
+		bool child_exact;
+		double value = this->SearchLevel(after, candidate.lines, level + 1, state, std::max(alpha, best), worker, parallel, &child_exact);
+		best = std::max(best, value);
+
+		after.Unmake(undo);
+	}
+
+	// The children that don't beat the best one are only bounded, the best one is exact if it beats alpha
+	*exact = best > alpha;
+	return best;
+}
+
+/* 
+======================================									
+Value of a board of the expectimax where the next piece is unknown: the average of the values of
+the pieces the randomizer can deal, weighted by their odds. Every piece appears with one of the
+rotations, with the same odds; the rotations that give the same moves are searched once
+
+Parameters:
+
+>> board:		Board of the node
+>> lines:		Lines cleared to reach the board
+>> level:		Level of the unknown piece in the search
+>> state:		State of the randomizer before the unknown piece
+>> alpha:		Value that the node has to beat to matter to its parent
+>> worker:		Worker of the pool running the search
+>> parallel:	The pieces are searched in parallel by the workers of the pool
+>> exact:		Receives false if the value is only an upper bound, at most alpha
+
+Returns the value of the board.
+====================================== 
+*/
+double Bot::ChanceNode(const Board& board, int lines, int level, uint64_t state, double alpha, int worker, bool parallel, bool* exact)
+{
+	// The values are kept without the score of the lines cleared before the node. They depend on
+	// the pieces the randomizer can deal, so the state of the randomizer is part of the key
+	int pieces_left = this->search_depth_ - level;
+	double lines_value = this->evaluator_.GetWeights().lines * lines;
+
+	uint64_t key = board.GetHash() ^ Zobrist::GetRandomizerKey(state);
+	TranspositionTable::Entry entry;
+	if (this->table_.Probe(key, &entry) && entry.depth == pieces_left)
+	{
+		*exact = true;
+		return entry.score + lines_value;
+	}
+
+	double odds[Pieces::kPieceKinds];
+	this->randomizer_->GetOdds(state, odds);
+
+	Outcome outcomes[kMaxOutcomes];
+	int count = 0;
+	for (int piece = 0; piece < Pieces::kPieceKinds; piece++)
+	{
+		if (odds[piece] <= 0)
+			continue;
+
+		uint64_t next_state = this->randomizer_->Deal(state, piece);
+		for (int rotation = 0; rotation < Pieces::kRotations; rotation++)
+		{
+			if (this->spawns_[piece][rotation] > 0)
+				outcomes[count++] = { piece, rotation, odds[piece] * this->spawns_[piece][rotation] / Pieces::kRotations, next_state };
+		}
+	}
+
+	// Highest value of a piece: it clears 4 lines at most
+	double bound = this->evaluator_.GetUpperBound(lines + 4 * pieces_left);
+
+	double sum = 0;
+	bool all_exact = true;
+	if (parallel)
+	{
+		// The pieces can't wait for each other's values, each one is bounded as if the others had the highest
+		double values[kMaxOutcomes];
+		bool exacts[kMaxOutcomes];
+		this->pool_.ParallelFor(count, [&](int outcome_worker, int i) {
+			const Outcome& outcome = outcomes[i];
+			double outcome_alpha = (alpha - (1 - outcome.odds) * bound) / outcome.odds;
+			values[i] = this->MaxNode(board, lines, level, outcome.piece, outcome.rotation, outcome.state, outcome_alpha, outcome_worker, false, &exacts[i]);
+		});
+
+		for (int i = 0; i < count; i++)
+		{
+			sum += outcomes[i].odds * values[i];
+			all_exact = all_exact && exacts[i];
+		}
+	}
+	else
+	{
+		double others = 1;						// Odds of the pieces not searched yet
+		for (int i = 0; i < count; i++)
+		{
+			const Outcome& outcome = outcomes[i];
+			others -= outcome.odds;
+
+			bool outcome_exact;
+			sum += outcome.odds * this->MaxNode(board, lines, level, outcome.piece, outcome.rotation, outcome.state, (alpha - sum - others * bound) / outcome.odds, worker, false, &outcome_exact);
+			all_exact = all_exact && outcome_exact;
+
+			// Star1: even if the pieces left have the highest value, the average doesn't beat alpha
+			if (i < count - 1 && sum + others * bound <= alpha)
+			{
+				*exact = false;
+				return sum + others * bound;
+			}
+		}
+	}
+
+	// Rounded like the values of the table, the value doesn't depend on finding it in the table
+	float value = (float) (sum - lines_value);
+
+	*exact = all_exact;
+	if (all_exact && !this->IsStopped())
+		this->table_.Store(key, value, pieces_left);
+
+	return value + lines_value;
+}
+
+// The search ran out of time
+bool Bot::IsStopped()
+{
+	if (this->stopped_.load(std::memory_order_relaxed))
+		return true;
+
+	if (this->settings_.time_budget_us > 0 && Clock::now() >= this->deadline_)
+	{
+		this->stopped_.store(true, std::memory_order_relaxed);
+		return true;
+	}
+
+	return false;
+}
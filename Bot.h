@@ -0,0 +1,125 @@
+/*****************************************************************************************
+/* File: Bot.h
+/* Desc: Player that chooses where to lock every piece with a beam search over the current
+/*       piece and the upcoming pieces of the queue, or an expectimax search that averages
+/*       over the pieces the randomizer can deal after them
+/*****************************************************************************************/
+
+#ifndef _BOT_
+#define _BOT_
+
+#include "Board.h"
+#include "Evaluator.h"
+#include "GameCore.h"
+#include "MoveGenerator.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Bot
+{
+public:
+
+	static const int kMaxPath = 128;			// Longest sequence of inputs to reach a move
+	static const int kMaxDepth = 8;				// Most pieces placed by a search
+
+	enum Search { eSearchBeam, eSearchExpectimax };
+
+	struct Settings
+	{
+		Search search = eSearchBeam;
+		int beam_width = 32;					// Boards kept at every level of the beam search
+		int branch_width = 8;					// Moves of every piece searched further by the expectimax, best evaluations first
+		int depth = 3;							// Pieces placed, the current one and depth - 1 after it
+		int preview = PieceQueue::kLookahead;	// Pieces of the queue the bot knows, the expectimax averages over the next ones
+		int time_budget_us = 20000;				// Time to choose a move, the search stops at the level it reached (0 = no limit)
+		ThreadPool* pool = nullptr;				// Pool that runs the search (nullptr = the global pool)
+		bool single_thread = false;				// Search on the calling thread only, without the pool, for many bots playing at once
+		EvalWeights weights;					// Evaluation of the boards
+		int table_megabytes = 16;				// Size of the transposition table, allocated when the bot is created
+	};
+
+	// Move chosen for the current piece and the inputs that bring the piece there
+	struct Decision
+	{
+		MoveGenerator::Move move;
+		GameCore::Input path[kMaxPath];
+		int path_length;
+		int depth;								// Levels of the search completed
+	};
+
+	Bot();
+	explicit Bot(const Settings& settings);
+
+	bool Think(const GameCore& core, Decision* decision);
+	bool Play(GameCore& core);
+
+	static void Apply(const Decision& decision, GameCore& core);
+
+private:
+
+	typedef std::chrono::steady_clock Clock;
+
+	// Board reached by a sequence of moves
+	struct Node
+	{
+		Board board;
+		double score;							// Lines cleared on the way and evaluation of the board
+		int lines;
+		int root;								// Move of the current piece that starts the sequence
+	};
+
+	// Move of the expectimax, evaluated on the board of its parent and made again if it is searched further
+	struct Candidate
+	{
+		MoveGenerator::Move move;
+		double score;
+		int lines;
+		int index;								// Order of the move in the generator, it breaks the ties of the evaluations
+	};
+
+	// Memory of a worker of the pool
+	struct Worker
+	{
+		MoveGenerator generator;
+		std::vector<Candidate> candidates[kMaxDepth];	// Moves of the piece of every level of the expectimax
+	};
+
+	Settings settings_;
+	Evaluator evaluator_;
+	TranspositionTable table_;					// Boards kept in the beam, values of the chance nodes of the expectimax
+	ThreadPool& pool_;
+	MoveGenerator root_generator_;
+	std::vector<std::unique_ptr<Worker>> workers_;
+	std::vector<Node> beam_;									// Boards of the current level, the moves of the current piece first
+	std::vector<std::vector<Node>> children_;					// Children of every node of the beam, filled in parallel
+	std::vector<Node> level_;									// Children of all the nodes of the beam
+	std::vector<Node> best_;
+	std::vector<int> order_;
+
+	// Expectimax
+	PieceQueue::Entry known_[kMaxDepth];		// Known piece of every level, the current piece and the preview
+	int known_count_;
+	const Randomizer* randomizer_;				// Randomizer of the game searched, it deals the unknown pieces
+	uint64_t unknown_state_;					// State of the randomizer after the known pieces
+	int spawns_[Pieces::kPieceKinds][Pieces::kRotations];	// Spawn rotations with the same moves as a rotation, 0 if it is counted with an earlier one
+	int search_depth_;							// Depth of the current iteration
+	Clock::time_point deadline_;
+	std::atomic<bool> stopped_;					// The time is over, the values of the iteration are dropped
+
+	int SearchBeam(const GameCore& core, int* depth);
+	void Expand(const Node& node, int piece, int rotation, MoveGenerator* generator, std::vector<Node>* children);
+	void KeepBest(std::vector<Node>* nodes, int level, const PieceQueue& queue);
+
+	int SearchExpectimax(const GameCore& core, int* depth);
+	double SearchLevel(const Board& board, int lines, int level, uint64_t state, double alpha, int worker, bool parallel, bool* exact);
+	double MaxNode(const Board& board, int lines, int level, int piece, int rotation, uint64_t state, double alpha, int worker, bool parallel, bool* exact);
+	double ChanceNode(const Board& board, int lines, int level, uint64_t state, double alpha, int worker, bool parallel, bool* exact);
+	bool IsStopped();
+};
+
+#endif // _BOT_
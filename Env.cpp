@@ -0,0 +1,173 @@
+/*****************************************************************************************
+/* File: Env.cpp
+/* Desc: Batch of headless games stepped together for reinforcement learning. The actions,
+/*       observations, rewards and done flags are contiguous arrays of the caller, with a
+/*       C API for the bindings of other languages
+/*****************************************************************************************/
+
+#include "Env.h"
+#include <algorithm>
+#include <functional>
+
+// The C API sees the batch as an opaque struct
+struct TetrisEnv
+{
+	Env env;
+
+	TetrisEnv(int count, Randomizer::Type randomizer) : env(count, randomizer) {}
+};
+
+/* 
+======================================									
+All the games are created here, stepping them doesn't allocate memory. The games start with the
+seeds 0..count-1 until they are reset
+
+Parameters:
+
+>> count:		Number of games
+>> randomizer:	Sequence of pieces of the games
+>> pool:		Pool that steps the games (nullptr = the global pool)
+====================================== 
+*/
+Env::Env(int count, Randomizer::Type randomizer, ThreadPool* pool)
+	: pool_(pool != nullptr ? *pool : ThreadPool::GetGlobal())
+{
+	for (int i = 0; i < count; i++)
+		this->cores_.push_back(std::make_unique<GameCore>((uint64_t) i, randomizer));
+}
+
+int Env::GetCount() const
+{
+	return (int) this->cores_.size();
+}
+
+const GameCore& Env::GetCore(int index) const
+{
+	return *this->cores_[index];
+}
+
+/* 
+======================================									
+Start a new game
+
+Parameters:
+
+>> index:		Game to reset
+>> seed:		Seed of the sequence of pieces, the same seed gives the same pieces
+>> observation:	Receives the observation of the new game, kObservationSize bytes
+====================================== 
+*/
+void Env::Reset(int index, uint64_t seed, uint8_t* observation)
+{
+	this->cores_[index]->Reset(seed);
+	Env::Observe(*this->cores_[index], observation);
+}
+
+/* 
+======================================									
+Start a new game in every slot
+
+Parameters:
+
+>> seeds:			Seed of every game
+>> observations:	Receives the observations, GetCount() * kObservationSize bytes
+====================================== 
+*/
+void Env::ResetAll(const uint64_t* seeds, uint8_t* observations)
+{
+	for (int i = 0; i < this->GetCount(); i++)
+		this->Reset(i, seeds[i], observations + (size_t) i * Env::kObservationSize);
+}
+
+/* 
+======================================									
+Step every game one tick (GameCore::kTickMs) with its action. The games are stepped in parallel,
+kGamesPerJob at a time. A game that is over stays over, with a reward of 0, until it is reset
+
+Parameters:
+
+>> actions:			Inputs of every game, a combination of GameCore::Input flags
+>> observations:	Receives the observations, GetCount() * kObservationSize bytes
+>> rewards:			Receives the lines cleared by every game during the tick
+>> dones:			Receives 1 for the games that are over, 0 for the others
+====================================== 
+*/
+void Env::Step(const int32_t* actions, uint8_t* observations, float* rewards, uint8_t* dones)
+{
+	int count = this->GetCount();
+	int jobs = (count + Env::kGamesPerJob - 1) / Env::kGamesPerJob;
+
+	auto step_games = [&](int /*worker*/, int job) {
+		int end = std::min(count, (job + 1) * Env::kGamesPerJob);
+		for (int i = job * Env::kGamesPerJob; i < end; i++)
+		{
+			GameCore& core = *this->cores_[i];
+
+			int score = core.GetScore();
+			if (!core.IsGameOver())
+				core.Step(actions[i], GameCore::kTickMs);
+
+			rewards[i] = (float) (core.GetScore() - score);
+			dones[i] = core.IsGameOver() ? 1 : 0;
+			Env::Observe(core, observations + (size_t) i * Env::kObservationSize);
+		}
+	};
+
+	// Passed by reference, the task fits in the std::function without allocating
+	this->pool_.ParallelFor(jobs, std::ref(step_games));
+}
+
+// Write the observation of a game, kObservationSize bytes
+void Env::Observe(const GameCore& core, uint8_t* observation)
+{
+	const Board& board = core.GetBoard();
+	for (int y = 0; y < Board::kBoardHeight; y++)
+		for (int x = 0; x < Board::kBoardWidth; x++)
+			observation[y * Board::kBoardWidth + x] = board.IsFreeBlock(x, y) ? 0 : 1;
+
+	observation[Env::kPieceValue] = (uint8_t) core.GetPiece();
+	observation[Env::kRotationValue] = (uint8_t) core.GetRotation();
+	observation[Env::kPosXValue] = (uint8_t) (core.GetPosX() + Env::kPositionOffset);
+	observation[Env::kPosYValue] = (uint8_t) (core.GetPosY() + Env::kPositionOffset);
+	observation[Env::kNextPieceValue] = (uint8_t) core.GetNextPiece();
+	observation[Env::kNextRotationValue] = (uint8_t) core.GetNextRotation();
+}
+
+// Returns nullptr if there are no games or the randomizer is not a Randomizer::Type
+TetrisEnv* tetris_env_create(int count, int randomizer)
+{
+	if (count <= 0 || randomizer < Randomizer::ePure || randomizer > Randomizer::eHistory)
+		return nullptr;
+
+	return new TetrisEnv(count, (Randomizer::Type) randomizer);
+}
+
+void tetris_env_destroy(TetrisEnv* env)
+{
+	delete env;
+}
+
+int tetris_env_count(const TetrisEnv* env)
+{
+	return env->env.GetCount();
+}
+
+int tetris_env_observation_size(void)
+{
+	return Env::kObservationSize;
+}
+
+void tetris_env_reset(TetrisEnv* env, int index, uint64_t seed, uint8_t* observation)
+{
+	env->env.Reset(index, seed, observation);
+}
+
+void tetris_env_reset_all(TetrisEnv* env, const uint64_t* seeds, uint8_t* observations)
+{
+	env->env.ResetAll(seeds, observations);
+}
+
+void tetris_env_step(TetrisEnv* env, const int32_t* actions, uint8_t* observations, float* rewards, uint8_t* dones)
+{
+	env->env.Step(actions, observations, rewards, dones);
+}
@@ -0,0 +1,77 @@
+/*****************************************************************************************
+/* File: Env.h
+/* Desc: Batch of headless games stepped together for reinforcement learning. The actions,
+/*       observations, rewards and done flags are contiguous arrays of the caller, with a
+/*       C API for the bindings of other languages
+/*****************************************************************************************/
+
+#ifndef _ENV_
+#define _ENV_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+
+#include "GameCore.h"
+#include "ThreadPool.h"
+#include <memory>
+#include <vector>
+
+class Env
+{
+public:
+
+	// Observation of a game, one byte per value
+	static const int kBoardCells = Board::kBoardWidth * Board::kBoardHeight;	// Occupancy of the board (0 = free, 1 = filled), line by line from the top
+	static const int kPieceValue = kBoardCells;			// Kind of the current piece
+	static const int kRotationValue = kBoardCells + 1;	// Rotation of the current piece
+	static const int kPosXValue = kBoardCells + 2;		// Position of the current piece + kPositionOffset
+	static const int kPosYValue = kBoardCells + 3;
+	static const int kNextPieceValue = kBoardCells + 4;	// Kind of the next piece
+	static const int kNextRotationValue = kBoardCells + 5;
+	static const int kObservationSize = kBoardCells + 6;
+
+	static const int kPositionOffset = Pieces::kPieceBlocks;	// The matrix of a piece can start out of the board
+	static const int kGamesPerJob = 128;				// Games stepped by a job of the pool
+
+	explicit Env(int count, Randomizer::Type randomizer = Randomizer::eBag7, ThreadPool* pool = nullptr);
+
+	int GetCount() const;
+	const GameCore& GetCore(int index) const;
+
+	void Reset(int index, uint64_t seed, uint8_t* observation);
+	void ResetAll(const uint64_t* seeds, uint8_t* observations);
+	void Step(const int32_t* actions, uint8_t* observations, float* rewards, uint8_t* dones);
+
+	static void Observe(const GameCore& core, uint8_t* observation);
+
+private:
+
+	std::vector<std::unique_ptr<GameCore>> cores_;
+	ThreadPool& pool_;
+};
+
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define ENV_API __declspec(dllexport)
+#else
+#define ENV_API __attribute__((visibility("default")))
+#endif
+
+typedef struct TetrisEnv TetrisEnv;
+
+ENV_API TetrisEnv* tetris_env_create(int count, int randomizer);
+ENV_API void tetris_env_destroy(TetrisEnv* env);
+ENV_API int tetris_env_count(const TetrisEnv* env);
+ENV_API int tetris_env_observation_size(void);
+ENV_API void tetris_env_reset(TetrisEnv* env, int index, uint64_t seed, uint8_t* observation);
+ENV_API void tetris_env_reset_all(TetrisEnv* env, const uint64_t* seeds, uint8_t* observations);
+ENV_API void tetris_env_step(TetrisEnv* env, const int32_t* actions, uint8_t* observations, float* rewards, uint8_t* dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _ENV_
@@ -0,0 +1,199 @@
+/*****************************************************************************************
+/* File: Evaluator.cpp
+/* Desc: Score of a board for the bots, a weighted sum of features computed with bit
+/*       operations on the occupancy masks of the lines
+/*****************************************************************************************/
+
+#include "Evaluator.h"
+#include "Bits.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	const int kLanes = 4;											// Lines in a 64 bit word
+	const int kDepthBits = 5;										// Bits of the depth of a well
+	const uint32_t kFull = (1u << Board::kBoardWidth) - 1;			// Columns of the board
+	const uint64_t kLaneOnes = 0x0001000100010001ull;				// Bit 0 of every lane
+	const uint64_t kLaneFull = kFull * kLaneOnes;
+	const uint64_t kWalls = (1 | (1u << (Board::kBoardWidth + 1))) * kLaneOnes;
+	const uint64_t kRowMask = ((kFull << 1) | 1) * kLaneOnes;		// Pairs of neighbour blocks, with the walls
+
+	static_assert(Board::kBoardWidth + 2 <= 16, "The lines and their walls must fit 16 bit lanes");
+	static_assert(Board::kBoardHeight % kLanes == 0, "The lines are read four at a time");
+	static_assert(Board::kBoardHeight < (1 << kDepthBits), "The depth of a well must fit its bits");
+}
+
+Evaluator::Evaluator()
+{
+}
+
+Evaluator::Evaluator(const EvalWeights& weights)
+	: weights_(weights)
+{
+}
+
+const EvalWeights& Evaluator::GetWeights() const
+{
+	return this->weights_;
+}
+
+/* 
+======================================									
+Score of a board, higher is better
+
+Parameters:
+
+>> board:	Board to evaluate
+>> lines:	Lines cleared to reach the board
+====================================== 
+*/
+double Evaluator::Evaluate(const Board& board, int lines) const
+{
+	Features features;
+	Evaluator::GetFeatures(board, lines, &features);
+
+	const EvalWeights& weights = this->weights_;
+	return weights.height * features.height
+		+ weights.max_height * features.max_height
+		+ weights.holes * features.holes
+		+ weights.row_transitions * features.row_transitions
+		+ weights.column_transitions * features.column_transitions
+		+ weights.wells * features.wells
+		+ weights.bumpiness * features.bumpiness
+		+ weights.lines * features.lines;
+}
+
+/* 
+======================================									
+Highest score that a board can have: every feature with a positive weight at its largest value
+on the board, the others at 0
+
+Parameters:
+
+>> lines:	Most lines that can be cleared to reach the board
+====================================== 
+*/
+double Evaluator::GetUpperBound(int lines) const
+{
+	const int w = Board::kBoardWidth;
+	const int h = Board::kBoardHeight;
+
+	const EvalWeights& weights = this->weights_;
+	return std::max(weights.height, 0.0) * (w * h)
+		+ std::max(weights.max_height, 0.0) * h
+		+ std::max(weights.holes, 0.0) * (w * h)
+		+ std::max(weights.row_transitions, 0.0) * ((w + 1) * h)
+		+ std::max(weights.column_transitions, 0.0) * (w * (h + 1))
+		+ std::max(weights.wells, 0.0) * (w * h * (h + 1) / 2)
+		+ std::max(weights.bumpiness, 0.0) * ((w - 1) * h)
+		+ std::max(weights.lines, 0.0) * lines;
+}
+
+/* 
+======================================									
+Compute the features of a board. The lines are read four at a time into the four 16 bit lanes of
+a 64 bit word (the line above in the lower lane), and every feature is computed for all the
+blocks of the four lines at once:
+
+- covered: the columns with a block in the line or above (OR of the lines down the columns).
+  The heights add up to the blocks of covered, the holes are the free blocks of covered
+- transitions: XOR of the lines with themselves shifted one column, or with the lines above
+- wells: free blocks with filled blocks (or walls) on both sides and nothing above. They are
+  followed down one line at a time with the depths of the columns kept in bit planes, a block
+  adds its depth in the well
+
+Parameters:
+
+>> board:		Board to evaluate
+>> lines:		Lines cleared to reach the board
+>> features:	Receives the features
+====================================== 
+*/
+void Evaluator::GetFeatures(const Board& board, int lines, Features* features)
+{
+	int height = 0;
+	int holes = 0;
+	int row_transitions = 0;
+	int column_transitions = 0;
+	int wells = 0;
+
+	uint32_t depth[kDepthBits] = {};			// Depth in the well of every column, bit b of the depths in depth[b]
+
+	uint64_t covered = 0;						// Lanes of the previous four lines, only the last one is used
+	uint64_t previous = 0;						// There is nothing above the board
+	for (int j = 0; j < Board::kBoardHeight; j += kLanes)
+	{
+		uint64_t line;
+		memcpy(&line, &board.GetLine(j), sizeof(line));		// The lines are stored one after the other
+
+		// Prefix OR down the four lanes, from the last line of the previous group
+		uint64_t down = line | ((covered >> 48) * kLaneOnes);
+		down |= down << 16;
+		down |= down << 32;
+		covered = down;
+
+		holes += Bits::PopCount(covered & ~line);
+		height += Bits::PopCount(covered);
+
+		// With the walls (bits 0 and kBoardWidth + 1 of every lane once the lines are shifted one column)
+		uint64_t walled = (line << 1) | kWalls;
+		row_transitions += Bits::PopCount((walled ^ (walled >> 1)) & kRowMask);
+		column_transitions += Bits::PopCount(line ^ ((line << 16) | (previous >> 48)));
+		previous = line;
+
+		// The wells continue down or end in every line, the depth of every column is incremented
+		// or reset on the bit planes and the planes of the four lines are added at once
+		uint64_t open = ~covered & (walled >> 2) & walled & kLaneFull;
+		if (open == 0)
+		{
+			for (int b = 0; b < kDepthBits; b++)
+				depth[b] = 0;
+			continue;
+		}
+
+		uint64_t planes[kDepthBits] = {};
+		for (int lane = 0; lane < kLanes; lane++)
+		{
+			uint32_t well = (uint32_t) (open >> (16 * lane)) & kFull;
+			uint32_t carry = well;
+			for (int b = 0; b < kDepthBits; b++)
+			{
+				depth[b] &= well;
+				uint32_t next = depth[b] & carry;
+				depth[b] ^= carry;
+				carry = next;
+
+				planes[b] |= (uint64_t) depth[b] << (16 * lane);
+			}
+		}
+
+		for (int b = 0; b < kDepthBits; b++)
+			wells += Bits::PopCount(planes[b]) << b;
+	}
+
+	// The floor is filled
+	uint32_t bottom = (uint32_t) (previous >> 48);
+	column_transitions += Bits::PopCount(~bottom & kFull);
+
+	int max_height = 0;
+	int bumpiness = 0;
+	for (int i = 0; i < Board::kBoardWidth; i++)
+	{
+		int column = board.GetColumnHeight(i);
+		if (column > max_height)
+			max_height = column;
+		if (i + 1 < Board::kBoardWidth)
+			bumpiness += abs(column - board.GetColumnHeight(i + 1));
+	}
+
+	features->height = height;
+	features->max_height = max_height;
+	features->holes = holes;
+	features->row_transitions = row_transitions;
+	features->column_transitions = column_transitions;
+	features->wells = wells;
+	features->bumpiness = bumpiness;
+	features->lines = lines;
+}
@@ -0,0 +1,56 @@
+/*****************************************************************************************
+/* File: Evaluator.h
+/* Desc: Score of a board for the bots, a weighted sum of features computed with bit
+/*       operations on the occupancy masks of the lines
+/*****************************************************************************************/
+
+#ifndef _EVALUATOR_
+#define _EVALUATOR_
+
+#include "Board.h"
+
+// Weight of every feature in the score, higher scores are better
+struct EvalWeights
+{
+	double height = -0.51;					// Sum of the heights of the columns
+	double max_height = 0;					// Height of the highest column
+	double holes = -0.36;					// Free blocks under a filled block
+	double row_transitions = -0.1;			// Free and filled blocks side by side in a line, the walls are filled
+	double column_transitions = -0.2;		// Free and filled blocks on top of each other in a column, the floor is filled
+	double wells = -0.1;					// Free blocks between two filled blocks and open from above, counted 1, 2, 3... down the well
+	double bumpiness = -0.18;				// Height differences between neighbour columns
+	double lines = 0.76;					// Lines cleared to reach the board
+};
+
+class Evaluator
+{
+public:
+
+	struct Features
+	{
+		int height;
+		int max_height;
+		int holes;
+		int row_transitions;
+		int column_transitions;
+		int wells;
+		int bumpiness;
+		int lines;
+	};
+
+	Evaluator();
+	explicit Evaluator(const EvalWeights& weights);
+
+	const EvalWeights& GetWeights() const;
+	double Evaluate(const Board& board, int lines) const;
+	double GetUpperBound(int lines) const;
+
+	static void GetFeatures(const Board& board, int lines, Features* features);
+
+private:
+
+	EvalWeights weights_;
+
+};
+
+#endif // _EVALUATOR_
@@ -5,20 +5,80 @@
 
 // ------ Includes -----
 #include "Game.h"
+#include <algorithm>
 #include <assert.h>
+#include <ctime>
 
 Game::Game() 
+	: core_((uint64_t) time(NULL))
 {
 	this->io_ = std::make_unique<IO>();
-	this->board_ = std::make_unique<Board>(this->io_->GetScreenWidth(), this->io_->GetScreenHeight());
-	this->InitGame();
+
+	this->next_pos_x_ = Board::kBoardWidth + 5;
+	this->next_pos_y_ = 5;
+
+	this->score_text_value_ = -1;
+
+	this->sim_time_us_ = this->io_->ClockGetElapsedTimeUS();
+	this->lag_us_ = 0;
+	this->next_frame_us_ = this->sim_time_us_;
+	this->queue_empty_us_ = this->sim_time_us_;
+
+	this->show_profiler_ = false;
+	this->profiler_text_time_us_ = 0;
+
+	this->autoplay_ = false;
+	this->next_bot_move_us_ = 0;
+	this->bot_found_ = false;
+	this->bot_thinking_ = false;
 }
 
+Game::~Game()
+{
+	// Keep the timings of the session, to compare builds
+	this->profiler_.WriteReport("frame_profile.csv");
+}
+
+/* 
+======================================									
+One iteration of the main loop
+
+The input is read every kInputPollUs, much more often than the frames are drawn, and every event
+is applied to the simulation at the time it was read. The scene is only drawn when a frame is due.
+The profiler records the latency of every input, from the previous read that found no event
+====================================== 
+*/
 void Game::Loop()
 {
-	this->DrawScene();			
+	this->profiler_.Begin(FrameProfiler::eProcessEvents);
 	this->ProcessEvents();
+	this->profiler_.End(FrameProfiler::eProcessEvents);
+
+	this->profiler_.Begin(FrameProfiler::eGameLogic);
 	this->GameLogic();
+	this->profiler_.End(FrameProfiler::eGameLogic);
+
+	int64_t now = this->io_->ClockGetElapsedTimeUS();
+	if (now >= this->next_frame_us_)
+	{
+		this->profiler_.Begin(FrameProfiler::eDrawScene);
+		this->DrawScene();
+		this->profiler_.End(FrameProfiler::eDrawScene);
+
+		this->profiler_.Begin(FrameProfiler::eUpdateScreen);
+		this->io_->UpdateScreen();							// Put the graphic context in the screen
+		this->profiler_.End(FrameProfiler::eUpdateScreen);
+
+		this->profiler_.EndFrame();							// The input polls since the previous frame count in this one
+
+		this->next_frame_us_ += Game::kFrameUs;
+		if (this->next_frame_us_ < now)
+			this->next_frame_us_ = now + Game::kFrameUs;		// Too late, skip the missed frames
+	}
+	else
+	{
+		this->io_->Sleep((int) std::min<int64_t>(Game::kInputPollUs, this->next_frame_us_ - now));
+	}
 }
 
 bool Game::IsRunning() const
@@ -26,53 +86,37 @@ bool Game::IsRunning() const
 	return this->io_->WindowIsOpen();
 }
 
+int Game::BoardPosition() const
+{
+	return this->io_->GetScreenWidth() / 2;
+}
+
 /* 
 ======================================									
-Get a random int between to integers
+Returns the horizontal position (isn pixels) of the block given like parameter
 
 Parameters:
->> a: First number
->> b: Second number
+
+>> pos:	Horizontal position of the block in the board
 ====================================== 
 */
-int Game::GetRand (int a, int b)
-{
-	return rand() % (b - a + 1) + a;
-}
-
-void Game::InitGame()
-{
-	srand((unsigned int) time(NULL));
-
-	// First piece
-	this->piece_			= Game::GetRand(0, 6);
-	this->rotation_			= Game::GetRand(0, 3);
-	this->pos_x_ 			= (Board::kBoardWidth / 2) + Pieces::GetXInitialPosition(this->piece_, this->rotation_);
-	this->pos_y_ 			= Pieces::GetYInitialPosition(this->piece_, this->rotation_);
-
-	//  Next piece
-	this->next_piece_ 		= Game::GetRand(0, 6);
-	this->next_rotation_ 	= Game::GetRand(0, 3);
-	this->next_pos_x_ 		= Board::kBoardWidth + 5;
-	this->next_pos_y_ 		= 5;
+int Game::GetXPosInPixels (int pos) const
+{	
+	return (this->BoardPosition() - Game::kBlockSize * Board::kBoardWidth / 2) + pos * Game::kBlockSize;
 }
 
 /* 
 ======================================									
-Create a random piece
+Returns the vertical position (in pixels) of the block given like parameter
+
+Parameters:
+
+>> pos:	Horizontal position of the block in the board
 ====================================== 
 */
-void Game::CreateNewPiece()
+int Game::GetYPosInPixels (int pos) const
 {
-	// New piece
-	this->piece_		= this->next_piece_;
-	this->rotation_		= this->next_rotation_;
-	this->pos_x_ 		= (Board::kBoardWidth / 2) + Pieces::GetXInitialPosition (this->piece_, this->rotation_);
-	this->pos_y_ 		= Pieces::GetYInitialPosition (this->piece_, this->rotation_);
-
-	// Random next piece
-	this->next_piece_ 		= GetRand (0, 6);
-	this->next_rotation_ 	= GetRand (0, 3);
+	return (this->io_->GetScreenHeight() - (Game::kBlockSize * Board::kBoardHeight)) + (pos * Game::kBlockSize);
 }
 
 /* 
@@ -90,27 +134,23 @@ Parameters:
 void Game::DrawPiece (int x, int y, int piece, int rotation)
 {
 	// Obtain the position in pixel in the screen of the block we want to draw
-	int pixels_x = this->board_->GetXPosInPixels(x);
-	int pixels_y = this->board_->GetYPosInPixels(y);
+	int pixels_x = this->GetXPosInPixels(x);
+	int pixels_y = this->GetYPosInPixels(y);
 
-	// Travel the matrix of blocks of the piece and draw the blocks that are filled
-	for (int i = 0; i < Board::kPieceBlocks; i++)
+	// Draw the filled blocks of the piece
+	const Pieces::Shape& shape = Pieces::GetShape(piece, rotation);
+	for (int k = 0; k < Pieces::kPieceCells; k++)
 	{
-		for (int j = 0; j < Board::kPieceBlocks; j++)
-		{
-			int block_type = Pieces::GetBlockType(piece, rotation, j, i);
-
-			if (block_type == 0)
-				continue;
-
-			IO::Color color = (block_type == 1) ? IO::eGreen : IO::eCyan;	// Color of the block 
-			
-			this->io_->DrawRectangle(pixels_x + i * Board::kBlockSize, 
-				pixels_y + j * Board::kBlockSize, 
-				(pixels_x + i * Board::kBlockSize) + Board::kBlockSize - 1, 
-				(pixels_y + j * Board::kBlockSize) + Board::kBlockSize - 1, 
-				color);
-		}
+		int i = shape.cells_x[k];
+		int j = shape.cells_y[k];
+
+		IO::Color color = (i == shape.pivot_x && j == shape.pivot_y) ? IO::eCyan : IO::eGreen;	// Color of the block 
+		
+		this->io_->AddQuad(pixels_x + i * Game::kBlockSize, 
+			pixels_y + j * Game::kBlockSize, 
+			(pixels_x + i * Game::kBlockSize) + Game::kBlockSize - 1, 
+			(pixels_y + j * Game::kBlockSize) + Game::kBlockSize - 1, 
+			color);
 	}
 }
 
@@ -124,19 +164,19 @@ Draw the two lines that delimit the board
 void Game::DrawBoard ()
 {
 	// Calculate the limits of the board in pixels	
-	int x1 = this->board_->BoardPosition() - (Board::kBlockSize * (Board::kBoardWidth / 2)) - 1;
-	int x2 = this->board_->BoardPosition() + (Board::kBlockSize * (Board::kBoardWidth / 2));
-	int y  = this->io_->GetScreenHeight() - (Board::kBlockSize * Board::kBoardHeight);
+	int x1 = this->BoardPosition() - (Game::kBlockSize * (Board::kBoardWidth / 2)) - 1;
+	int x2 = this->BoardPosition() + (Game::kBlockSize * (Board::kBoardWidth / 2));
+	int y  = this->io_->GetScreenHeight() - (Game::kBlockSize * Board::kBoardHeight);
 	
 	// Check that the vertical margin is not to small
-	assert (y > Board::kMinVerticalMargin);
+	assert (y > Game::kMinVerticalMargin);
 
 	// Rectangles that delimits the board
-	this->io_->DrawRectangle(x1 - Board::kBoardLineWidth, y, x1, this->io_->GetScreenHeight() - 1, IO::eBlue);
-	this->io_->DrawRectangle(x2, y, x2 + Board::kBoardLineWidth, this->io_->GetScreenHeight() - 1, IO::eBlue);
+	this->io_->AddQuad(x1 - Game::kBoardLineWidth, y, x1, this->io_->GetScreenHeight() - 1, IO::eBlue);
+	this->io_->AddQuad(x2, y, x2 + Game::kBoardLineWidth, this->io_->GetScreenHeight() - 1, IO::eBlue);
 	
 	// Check that the horizontal margin is not to small
-	assert (x1 > Board::kMinHorizontalMargin);
+	assert (x1 > Game::kMinHorizontalMargin);
 
 	// Drawing the blocks that are already stored in the board
 	x1 += 1;
@@ -145,11 +185,11 @@ void Game::DrawBoard ()
 		for (int j = 0; j < Board::kBoardHeight; j++)
 		{	
 			// Check if the block is filled, if so, draw it
-			if (!this->board_->IsFreeBlock(i, j))
-				this->io_->DrawRectangle(x1 + i * Board::kBlockSize,
-										y + j * Board::kBlockSize, 
-										(x1 + i * Board::kBlockSize) + Board::kBlockSize - 1, 
-										(y + j * Board::kBlockSize) + Board::kBlockSize - 1, 
+			if (!this->core_.GetBoard().IsFreeBlock(i, j))
+				this->io_->AddQuad(x1 + i * Game::kBlockSize,
+										y + j * Game::kBlockSize, 
+										(x1 + i * Game::kBlockSize) + Game::kBlockSize - 1, 
+										(y + j * Game::kBlockSize) + Game::kBlockSize - 1, 
 										IO::eRed);
 		}
 	}	
@@ -157,18 +197,26 @@ void Game::DrawBoard ()
 
 void Game::DrawScore()
 {
-	this->io_->DrawText(Game::kScoreX, 
+	if (this->score_text_value_ != this->core_.GetScore())
+	{
+		this->score_text_value_ = this->core_.GetScore();
+		this->score_text_ = "Score: " + std::to_string(this->score_text_value_);
+	}
+
+	this->io_->DrawText(Game::eTextScore,
+		Game::kScoreX, 
 		Game::kScoreY, 
-		"Score: " + std::to_string(this->score_), 
+		this->score_text_, 
 		Game::kFontSize, 
 		IO::eGreen);
 }
 
 void Game::DrawGameOver()
 {
-	assert(this->board_->IsGameOver());
+	assert(this->core_.IsGameOver());
 	// align with score
 	this->io_->DrawText(
+		Game::eTextGameOver,
 		Game::kScoreX,
 		Game::kScoreY + Game::kFontSize + Game::kLineSpace,
 		"GAME OVER",
@@ -178,10 +226,11 @@ void Game::DrawGameOver()
 
 void Game::DrawTextNext()
 {
-	int x = this->board_->GetXPosInPixels(this->next_pos_x_);
-	int y = this->board_->GetYPosInPixels(this->next_pos_y_) - Game::kFontSize - Game::kLineSpace;
+	int x = this->GetXPosInPixels(this->next_pos_x_);
+	int y = this->GetYPosInPixels(this->next_pos_y_) - Game::kFontSize - Game::kLineSpace;
 
 	this->io_->DrawText(
+		Game::eTextNext,
 		x,
 		y,
 		"NEXT:",
@@ -192,21 +241,41 @@ void Game::DrawTextNext()
 
 void Game::DrawControls()
 {
-	int board_height_pixels = this->board_->GetYPosInPixels(Board::kBoardHeight);
+	int board_height_pixels = this->GetYPosInPixels(Board::kBoardHeight);
 	// align with score
 	int x = Game::kScoreX;
-	int y = board_height_pixels - Game::kScoreY - Game::kFontSize * 2 - Game::kLineSpace;
+	int y = board_height_pixels - Game::kScoreY - Game::kFontSize * 3 - Game::kLineSpace;
 
 	this->io_->DrawText(
+		Game::eTextControls,
 		x,
 		y,
-		"Rotate=Z\nDrop=X",
+		"Rotate=Z\nDrop=X\nAutoplay=A",
 		Game::kFontSize,
 		IO::eGreen
 	);
 
 }
 
+void Game::DrawProfiler()
+{
+	// The numbers are only refreshed from time to time, so they can be read and the text is not rebuilt every frame
+	int64_t now = this->io_->ClockGetElapsedTimeUS();
+	if (this->profiler_text_.empty() || now - this->profiler_text_time_us_ > Game::kProfilerRefreshUs)
+	{
+		this->profiler_text_ = this->profiler_.GetReport();
+		this->profiler_text_time_us_ = now;
+	}
+
+	this->io_->DrawText(
+		Game::eTextProfiler,
+		Game::kScoreX,
+		Game::kScoreY + (Game::kFontSize + Game::kLineSpace) * 2,
+		this->profiler_text_,
+		Game::kProfilerFontSize,
+		IO::eYellow);
+}
+
 /* 
 ======================================									
 Draw scene
@@ -218,19 +287,24 @@ void Game::DrawScene ()
 {	
 	this->io_->ClearScreen();
 
+	// The blocks and the board limits are collected and drawn in a single batch
+	this->io_->BeginBatch();
+
 	this->DrawBoard ();							// Draw the delimitation lines and blocks stored in the board
-	this->DrawPiece		(this->pos_x_, 
-						this->pos_y_, 
-						this->piece_, 
-						this->rotation_);		// Draw the playing piece
+	this->DrawPiece		(this->core_.GetPosX(), 
+						this->core_.GetPosY(), 
+						this->core_.GetPiece(), 
+						this->core_.GetRotation());		// Draw the playing piece
 	this->DrawPiece		(this->next_pos_x_, 
 						this->next_pos_y_, 
-						this->next_piece_, 
-						this->next_rotation_);	// Draw the next piece
+						this->core_.GetNextPiece(), 
+						this->core_.GetNextRotation());	// Draw the next piece
+
+	this->io_->FlushBatch();
 
 	this->DrawScore();
 
-	if (this->board_->IsGameOver())
+	if (this->core_.IsGameOver())
 	{
 		this->DrawGameOver();
 	}
@@ -238,7 +312,8 @@ void Game::DrawScene ()
 	this->DrawTextNext();
 	this->DrawControls();
 
-	this->io_->UpdateScreen();					// Put the graphic context in the screen
+	if (this->show_profiler_)
+		this->DrawProfiler();
 }
 
 void Game::ProcessEvents()
@@ -252,83 +327,123 @@ void Game::ProcessEvents()
 		}
 		else if (event.type == IO::eKeyPressed)
 		{
-			if (event.key == IO::eKeyEscape)
+			GameCore::Input input = GameCore::eInputNone;
+
+			switch (event.key)
 			{
+			case (IO::eKeyEscape):
 				this->io_->CloseWindow();
-				break;
-			}
+				return;
 
-			if (this->board_->IsGameOver())
+			case (IO::eKeyProfiler):
+				this->show_profiler_ = !this->show_profiler_;
 				continue;
 
-			// Process keys other than Esc
+			case (IO::eKeyAutoplay):
+				if (this->bot_ == nullptr)
+				{
+					// The bot sees the pieces the player sees: the current one and the next one
+					Bot::Settings settings;
+					settings.search = Bot::eSearchExpectimax;
+					settings.preview = 1;
+					this->bot_ = std::make_unique<Bot>(settings);
+				}
+				this->autoplay_ = !this->autoplay_;
+				this->next_bot_move_us_ = event.time_us;
+				continue;
 
-			switch (event.key)
-			{
-			case (IO::eKeyRight):
-				if (this->board_->IsPossibleMovement(this->pos_x_ + 1, this->pos_y_, this->piece_, this->rotation_))
-					this->pos_x_++;
-				break;
+			case (IO::eKeyRight):	input = GameCore::eInputRight;	break;
+			case (IO::eKeyLeft):	input = GameCore::eInputLeft;	break;
+			case (IO::eKeyDown):	input = GameCore::eInputDown;	break;
+			case (IO::eKeyDrop):	input = GameCore::eInputDrop;	break;
+			case (IO::eKeyRotate):	input = GameCore::eInputRotate;	break;
+			default:				break;
+			}
 
-			case (IO::eKeyLeft):
-				if (this->board_->IsPossibleMovement(this->pos_x_ - 1, this->pos_y_, this->piece_, this->rotation_))
-					this->pos_x_--;
-				break;
+			// The piece is the bot's while it thinks
+			if (this->bot_thinking_)
+				continue;
 
-			case (IO::eKeyDown):
-				if (this->board_->IsPossibleMovement(this->pos_x_, this->pos_y_ + 1, this->piece_, this->rotation_))
-					this->pos_y_++;
-				break;
+			// Simulate up to the moment the key was read, then apply it
+			this->AdvanceTo(event.time_us);
+			this->core_.Step(input, 0);
 
-			case (IO::eKeyDrop):
-				// Check collision from up to down
-				while (this->board_->IsPossibleMovement(this->pos_x_, this->pos_y_, this->piece_, this->rotation_))
-					this->pos_y_++;
+			// The key can have been pressed right after the previous read that found no event, while
+			// the loop was drawing or sleeping: the latency counts from then
+			this->profiler_.RecordInputLatency(this->io_->ClockGetElapsedTimeUS() - this->queue_empty_us_);
+		}
 
-				this->board_->StorePiece(this->pos_x_, this->pos_y_ - 1, this->piece_, this->rotation_);
+	}
 
-				this->score_ += this->board_->DeletePossibleLines();
+	// The read that ended the loop found no event
+	this->queue_empty_us_ = event.time_us;
+}
 
-				if (!this->board_->IsGameOver())
-					this->CreateNewPiece();
+/* 
+======================================									
+Advance the simulation to the clock time, and let the bot play when the autoplay is on
 
-				break;
+The search of the bot runs on the thread pool, so the input is still read and the frames are
+still drawn while it thinks. The game is paused until the search ends: the bot reads core_ while
+it searches, and the move it chose is only valid for the state it searched
+====================================== 
+*/
+void Game::GameLogic()
+{
+	int64_t now = this->io_->ClockGetElapsedTimeUS();
 
-			case (IO::eKeyRotate):
-				if (this->board_->IsPossibleMovement(this->pos_x_, this->pos_y_, this->piece_, (this->rotation_ + 1) % 4))
-					this->rotation_ = (this->rotation_ + 1) % 4;
-				break;
-			}
+	if (this->bot_thinking_)
+	{
+		if (!this->bot_search_.IsDone())
+		{
+			this->sim_time_us_ = now;				// The time of the search is not simulated
+			return;
 		}
 
+		// The bot moves the piece and drops it at once, between two ticks, so the gravity can't get in the way
+		this->bot_thinking_ = false;
+		if (this->autoplay_ && this->bot_found_)
+			Bot::Apply(this->bot_decision_, this->core_);
+	}
+
+	this->AdvanceTo(now);
+
+	if (this->autoplay_ && now >= this->next_bot_move_us_ && !this->core_.IsGameOver())
+	{
+		this->bot_thinking_ = true;
+		this->bot_search_.Run([this]() { this->bot_found_ = this->bot_->Think(this->core_, &this->bot_decision_); });
+
+		// A pool of one worker has no other thread to run the search
+		if (ThreadPool::GetGlobal().GetWorkerCount() == 1)
+			this->bot_search_.Wait();
+
+		this->next_bot_move_us_ = now + Game::kBotMoveUs;
 	}
 }
 
-void Game::GameLogic()
+/* 
+======================================									
+Advance the simulation up to a clock time
+
+The simulation always moves in fixed ticks, the part of a tick that is left over is kept for the
+next call, so the falling speed doesn't depend on the frame rate
+
+Parameters:
+
+>> time_us:	Clock time in microseconds
+====================================== 
+*/
+void Game::AdvanceTo(int64_t time_us)
 {
-	if (this->board_->IsGameOver())
+	if (time_us <= this->sim_time_us_)
 		return;
-	
-	// Vertical movement
-	const int kWaitTime = 700;		// Number of milliseconds that the piece remains before going 1 block down
-
-	if (this->io_->ClockGetElapsedTimeMS() > kWaitTime)
-	{
-		if (this->board_->IsPossibleMovement(this->pos_x_, this->pos_y_ + 1, this->piece_, this->rotation_))
-		{
-			this->pos_y_++;
-		}
-		else
-		{
-			this->board_->StorePiece(this->pos_x_, this->pos_y_, this->piece_, this->rotation_);
 
-			this->score_ += this->board_->DeletePossibleLines();
+	this->lag_us_ += std::min<int64_t>(time_us - this->sim_time_us_, Game::kMaxFrameUs);
+	this->sim_time_us_ = time_us;
 
-			if (!this->board_->IsGameOver())
-			{
-				this->CreateNewPiece();
-			}
-		}
-		this->io_->ClockReset();
+	while (this->lag_us_ >= Game::kTickUs)
+	{
+		this->core_.Step(GameCore::eInputNone, GameCore::kTickMs);
+		this->lag_us_ -= Game::kTickUs;
 	}
-}
\ No newline at end of file
+}
@@ -1,14 +1,17 @@
 /******************************************************************************************/
 // File: Game.h
-// Desc: General class for the game
+// Desc: General class for the game, SFML front-end on top of the GameCore
 /******************************************************************************************/
 
 #ifndef _GAME_
 #define _GAME_
 
 #include "Board.h"
+#include "Bot.h"
+#include "GameCore.h"
 #include "Pieces.h"
 #include "IO.h"
+#include "Profiler.h"
 #include <memory>
 
 class Game
@@ -16,6 +19,7 @@ class Game
 public:
 
 	Game();
+	~Game();
 
 	bool IsRunning() const;
 	void Loop();
@@ -27,17 +31,51 @@ private:
 	static const int kFontSize = 24;
 	static const int kLineSpace = kFontSize / 3;
 
-	int next_pos_x_, next_pos_y_;			// Position of the next piece (blocks)
-	int next_piece_, next_rotation_;		// Kind and rotation of the next piece
+	enum TextSlot { eTextScore, eTextGameOver, eTextNext, eTextControls, eTextProfiler };	// Slots of the texts cached by IO
 
-	int score_;								// Number of cleared lines
+	static const int kProfilerFontSize = 8;
+	static const int kProfilerRefreshUs = 500000;	// Time between two updates of the numbers of the profiler overlay
 
-	std::unique_ptr<Board> board_;
-	std::unique_ptr<IO> io_;
+	static const int kBoardLineWidth = 6;			// Width of each of the two lines that delimit the board
+	static const int kBlockSize = 16;				// Width and Height of each block of a piece
+	static const int kMinVerticalMargin = 5;		// Minimum vertical margin for the board limit 		
+	static const int kMinHorizontalMargin = 5;		// Minimum horizontal margin for the board limit
+
+	static const int kTickUs = GameCore::kTickMs * 1000;	// Duration of a simulation tick in microseconds
+	static const int kMaxFrameUs = 250000;					// Longest time simulated in one frame, after a stall the game slows down instead of catching up
+	static const int kFrameUs = 1000000 / 30;				// Time between two rendered frames
+	static const int kInputPollUs = 1000;					// Time between two reads of the input
+	static const int kBotMoveUs = 1000000 / 10;				// Time between two pieces played by the bot
+
+	int next_pos_x_, next_pos_y_;			// Position of the next piece (blocks)
 
-	static int GetRand(int a, int b);
+	int score_text_value_;					// Score shown by score_text_, the text is only rebuilt when the score changes
+	std::string score_text_;
 
-	void InitGame();
+	std::unique_ptr<IO> io_;
+	GameCore core_;
+
+	int64_t sim_time_us_;					// Clock time of the previous GameLogic
+	int64_t lag_us_;						// Time elapsed that has not been simulated yet, less than one tick after GameLogic
+	int64_t next_frame_us_;					// Clock time when the next frame has to be drawn
+	int64_t queue_empty_us_;				// Clock time when the input was last read with no event left, the events read next can be that old
+
+	FrameProfiler profiler_;
+	bool show_profiler_;					// Draw the timings of the frame (toggled with F3)
+	std::string profiler_text_;
+	int64_t profiler_text_time_us_;			// Clock time when profiler_text_ was last updated
+
+	std::unique_ptr<Bot> bot_;				// Created the first time the autoplay is turned on
+	bool autoplay_;							// The bot plays (toggled with A)
+	int64_t next_bot_move_us_;				// Clock time when the bot plays the next piece
+	Bot::Decision bot_decision_;			// Filled by the search
+	bool bot_found_;						// The search found a move
+	bool bot_thinking_;						// The search runs on the pool, the game is paused until it ends
+	TaskGroup bot_search_;					// Declared after the bot and the decision, so it waits for the search before they are gone
+
+	int BoardPosition() const;				// Center position of the board from the left of the screen
+	int GetXPosInPixels(int pos) const;
+	int GetYPosInPixels(int pos) const;
 
 	void DrawScene();
 	void DrawPiece(int x, int y, int piece, int rotation);
@@ -47,14 +85,11 @@ private:
 	void DrawGameOver();
 	void DrawTextNext();
 	void DrawControls();
+	void DrawProfiler();
 
 	void ProcessEvents();
 	void GameLogic();
-
-	void CreateNewPiece();
-
-	int pos_x_, pos_y_;				// Position of the piece that is falling down
-	int piece_, rotation_;			// Kind and rotation the piece that is falling down
+	void AdvanceTo(int64_t time_us);
 };
 
 #endif // _GAME
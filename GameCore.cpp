@@ -0,0 +1,220 @@
+/*****************************************************************************************
+/* File: GameCore.cpp
+/* Desc: State and rules of the game. It has no dependency on the window, the input devices
+/*       or the clock, so it can be stepped headless and faster than real time
+/*****************************************************************************************/
+
+#include "GameCore.h"
+
+/* 
+======================================									
+Parameters:
+
+>> seed:		Seed of the sequence of pieces
+>> randomizer:	Generator of the sequence of pieces
+====================================== 
+*/
+GameCore::GameCore(uint64_t seed, Randomizer::Type randomizer)
+	: queue_(randomizer)
+{
+	this->Reset(seed);
+}
+
+/* 
+======================================									
+Start a new game with an empty board. Games started with the same seed get the same pieces
+
+Parameters:
+
+>> seed:	Seed of the sequence of pieces
+====================================== 
+*/
+void GameCore::Reset(uint64_t seed)
+{
+	this->board_ = Board();
+	this->score_ = 0;
+	this->piece_count_ = 0;
+	this->fall_time_ms_ = 0;
+
+	// First piece
+	this->queue_.Reset(seed);
+	this->CreateNewPiece();
+}
+
+/* 
+======================================									
+Take the next piece out of the queue
+====================================== 
+*/
+void GameCore::CreateNewPiece()
+{
+	PieceQueue::Entry next = this->queue_.Pop();
+
+	this->piece_		= next.piece;
+	this->rotation_		= next.rotation;
+	this->pos_x_ 		= (Board::kBoardWidth / 2) + Pieces::GetXInitialPosition (this->piece_, this->rotation_);
+	this->pos_y_ 		= Pieces::GetYInitialPosition (this->piece_, this->rotation_);
+}
+
+/* 
+======================================									
+Store the falling piece at its current position, delete the full lines and bring the next piece
+====================================== 
+*/
+void GameCore::LockPiece()
+{
+	this->board_.StorePiece(this->pos_x_, this->pos_y_, this->piece_, this->rotation_);
+	this->piece_count_++;
+
+	this->score_ += this->board_.DeletePossibleLines();
+
+	if (!this->board_.IsGameOver())
+		this->CreateNewPiece();
+}
+
+void GameCore::ProcessInput(Input input)
+{
+	switch (input)
+	{
+	case (GameCore::eInputRight):
+		if (this->board_.IsPossibleMovement(this->pos_x_ + 1, this->pos_y_, this->piece_, this->rotation_))
+			this->pos_x_++;
+		break;
+
+	case (GameCore::eInputLeft):
+		if (this->board_.IsPossibleMovement(this->pos_x_ - 1, this->pos_y_, this->piece_, this->rotation_))
+			this->pos_x_--;
+		break;
+
+	case (GameCore::eInputDown):
+		if (this->board_.IsPossibleMovement(this->pos_x_, this->pos_y_ + 1, this->piece_, this->rotation_))
+			this->pos_y_++;
+		break;
+
+	case (GameCore::eInputDrop):
+		this->pos_y_ = this->board_.GetDropPosition(this->pos_x_, this->pos_y_, this->piece_, this->rotation_);
+
+		this->LockPiece();
+		break;
+
+	case (GameCore::eInputRotate):
+		if (this->board_.IsPossibleMovement(this->pos_x_, this->pos_y_, this->piece_, (this->rotation_ + 1) % 4))
+			this->rotation_ = (this->rotation_ + 1) % 4;
+		break;
+
+	default:
+		break;
+	}
+}
+
+/* 
+======================================									
+Advance the game: apply the inputs of the player and let the piece fall down
+
+Parameters:
+
+>> inputs:	Combination of Input flags, applied in the order left, right, rotate, down, drop
+>> dt_ms:	Milliseconds elapsed since the previous step
+====================================== 
+*/
+void GameCore::Step(int inputs, int dt_ms)
+{
+	static const Input kInputOrder[] = { eInputLeft, eInputRight, eInputRotate, eInputDown, eInputDrop };
+
+	for (Input input : kInputOrder)
+	{
+		if (this->board_.IsGameOver())
+			return;
+
+		if ((inputs & input) != 0)
+			this->ProcessInput(input);
+	}
+
+	// Vertical movement
+	this->fall_time_ms_ += dt_ms;
+	while (this->fall_time_ms_ >= GameCore::kWaitTime && !this->board_.IsGameOver())
+	{
+		this->fall_time_ms_ -= GameCore::kWaitTime;
+
+		if (this->board_.IsPossibleMovement(this->pos_x_, this->pos_y_ + 1, this->piece_, this->rotation_))
+			this->pos_y_++;
+		else
+			this->LockPiece();
+	}
+}
+
+const Board& GameCore::GetBoard() const
+{
+	return this->board_;
+}
+
+bool GameCore::IsGameOver() const
+{
+	return this->board_.IsGameOver();
+}
+
+int GameCore::GetScore() const
+{
+	return this->score_;
+}
+
+int GameCore::GetPieceCount() const
+{
+	return this->piece_count_;
+}
+
+int GameCore::GetPosX() const
+{
+	return this->pos_x_;
+}
+
+int GameCore::GetPosY() const
+{
+	return this->pos_y_;
+}
+
+int GameCore::GetPiece() const
+{
+	return this->piece_;
+}
+
+int GameCore::GetRotation() const
+{
+	return this->rotation_;
+}
+
+int GameCore::GetNextPiece() const
+{
+	return this->queue_.Peek(0).piece;
+}
+
+int GameCore::GetNextRotation() const
+{
+	return this->queue_.Peek(0).rotation;
+}
+
+const PieceQueue& GameCore::GetQueue() const
+{
+	return this->queue_;
+}
+
+/* 
+======================================									
+Returns the hash of the whole state that decides the rest of the game: the board, the falling
+piece, the time until it falls, the upcoming pieces with their rotations and the generator of
+the pieces after them
+====================================== 
+*/
+uint64_t GameCore::GetHash() const
+{
+	uint64_t hash = this->board_.GetHash() ^ Zobrist::GetPieceKey(this->piece_, this->rotation_, this->pos_x_, this->pos_y_);
+	hash ^= Zobrist::GetFallTimeKey(this->fall_time_ms_);
+
+	for (int i = 0; i < PieceQueue::kLookahead; i++)
+	{
+		const PieceQueue::Entry& entry = this->queue_.Peek(i);
+		hash ^= Zobrist::GetQueueKey(i, entry.piece) ^ Zobrist::GetQueueRotationKey(i, entry.rotation);
+	}
+
+	return hash ^ this->queue_.GetGeneratorHash();
+}
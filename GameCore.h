@@ -0,0 +1,61 @@
+/*****************************************************************************************
+/* File: GameCore.h
+/* Desc: State and rules of the game. It has no dependency on the window, the input devices
+/*       or the clock, so it can be stepped headless and faster than real time
+/*****************************************************************************************/
+
+#ifndef _GAME_CORE_
+#define _GAME_CORE_
+
+#include "Board.h"
+#include "Pieces.h"
+#include "Randomizer.h"
+#include <cstdint>
+
+class GameCore
+{
+public:
+
+	// Actions of the player, they can be combined as flags in the inputs of Step
+	enum Input { eInputNone = 0, eInputLeft = 1, eInputRight = 2, eInputDown = 4, eInputRotate = 8, eInputDrop = 16 };
+
+	explicit GameCore(uint64_t seed, Randomizer::Type randomizer = Randomizer::eBag7);
+
+	void Reset(uint64_t seed);
+	void Step(int inputs, int dt_ms);
+
+	const Board& GetBoard() const;
+	bool IsGameOver() const;
+	int GetScore() const;
+	int GetPieceCount() const;
+
+	int GetPosX() const;
+	int GetPosY() const;
+	int GetPiece() const;
+	int GetRotation() const;
+	int GetNextPiece() const;
+	int GetNextRotation() const;
+	const PieceQueue& GetQueue() const;
+	uint64_t GetHash() const;
+
+	static const int kWaitTime = 700;		// Number of milliseconds that the piece remains before going 1 block down
+	static const int kTickMs = 4;			// Duration of a fixed simulation tick (250 Hz), kWaitTime is a whole number of ticks
+
+private:
+
+	Board board_;
+
+	int pos_x_, pos_y_;						// Position of the piece that is falling down
+	int piece_, rotation_;					// Kind and rotation the piece that is falling down
+	PieceQueue queue_;						// Upcoming pieces
+
+	int score_;								// Number of cleared lines
+	int piece_count_;						// Number of pieces stored in the board
+	int fall_time_ms_;						// Time elapsed since the piece last went 1 block down
+
+	void CreateNewPiece();
+	void ProcessInput(Input input);
+	void LockPiece();
+};
+
+#endif // _GAME_CORE_
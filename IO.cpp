@@ -13,11 +13,13 @@
 IO::IO() 
 {
 	this->window_ = std::make_unique<sf::RenderWindow>(sf::VideoMode(640, 480), "SUPER MEGA TETRIS");
-	this->window_->setVerticalSyncEnabled(true);
-	this->window_->setFramerateLimit(30);
+	// No vertical sync nor frame rate limit: they block in UpdateScreen, the game paces the frames itself
+	// so that it can keep reading the input while it waits for the next frame
+	this->window_->setVerticalSyncEnabled(false);
+
+	this->batch_.setPrimitiveType(sf::Quads);
 
 	this->clock_ = sf::Clock();
-	this->ClockReset();
 
 	//if (!this->font_.loadFromFile("joystix.ttf"))
 	if (!this->font_.loadFromMemory(Resources::joystix_ttf, Resources::joystix_ttf_len))
@@ -57,13 +59,26 @@ sf::Keyboard::Key IO::GetKey(Key key)
 	case eKeyRotate:	return sf::Keyboard::Z;
 	case eKeyDrop:		return sf::Keyboard::X;
 	case eKeyEscape:	return sf::Keyboard::Escape;
+	case eKeyProfiler:	return sf::Keyboard::F3;
+	case eKeyAutoplay:	return sf::Keyboard::A;
 	default:			assert(false);
 	}
 }
 
 /*
 ======================================
-Draw a rectangle of a given color
+Start a batch of quads. The quads are only collected by AddQuad and sent to the window in a
+single draw call by FlushBatch
+======================================
+*/
+void IO::BeginBatch()
+{
+	this->batch_.clear();		// Keeps the memory of the previous frames
+}
+
+/*
+======================================
+Add a rectangle of a given color to the current batch
 
 Parameters:
 >> x1, y1: 		Upper left corner of the rectangle
@@ -71,23 +86,85 @@ Parameters:
 >> color		Rectangle color
 ======================================
 */
-void IO::DrawRectangle (int x1, int y1, int x2, int y2, Color color)
+void IO::AddQuad(int x1, int y1, int x2, int y2, Color color)
+{
+	sf::Color sf_color = IO::GetColor(color);
+	this->batch_.append(sf::Vertex(sf::Vector2f((float)x1, (float)y1), sf_color));
+	this->batch_.append(sf::Vertex(sf::Vector2f((float)x2, (float)y1), sf_color));
+	this->batch_.append(sf::Vertex(sf::Vector2f((float)x2, (float)y2), sf_color));
+	this->batch_.append(sf::Vertex(sf::Vector2f((float)x1, (float)y2), sf_color));
+}
+
+void IO::FlushBatch()
 {
-	sf::RectangleShape shape(sf::Vector2f((float)(x2 - x1), (float)(y2 - y1)));
-	shape.setPosition(sf::Vector2f((float)x1, (float)y1));
-	shape.setFillColor(IO::GetColor(color));
-	this->window_->draw(shape);
+	if (this->batch_.getVertexCount() > 0)
+		this->window_->draw(this->batch_);
+
+	this->batch_.clear();
 }
 
-void IO::DrawText(int x, int y, std::string text_to_draw, int size, Color color)
+/*
+======================================
+Draw a text. Every slot keeps its own sf::Text between calls and only updates the properties
+that changed since the previous call, so a text that doesn't change is never laid out again
+
+Parameters:
+>> slot:			Identifier of the text, the caller uses one slot for each text on the screen
+>> x, y: 			Upper left corner of the text
+>> text_to_draw		Text, it can have several lines
+>> size				Character size in pixels
+>> color			Text color
+======================================
+*/
+void IO::DrawText(int slot, int x, int y, const std::string& text_to_draw, int size, Color color)
 {
-	sf::Text text;
-	text.setFont(this->font_);
-	text.setString(text_to_draw);
-	text.setCharacterSize(size);
-	text.setFillColor(IO::GetColor(color));
-	text.setPosition(sf::Vector2f(x, y));
-	this->window_->draw(text);
+	assert(slot >= 0);
+
+	if (slot >= (int) this->texts_.size())
+		this->texts_.resize(slot + 1);
+
+	std::unique_ptr<CachedText>& cached = this->texts_[slot];
+	if (!cached)
+	{
+		cached = std::make_unique<CachedText>();
+		cached->text.setFont(this->font_);
+		cached->text.setString(text_to_draw);
+		cached->text.setCharacterSize(size);
+		cached->text.setFillColor(IO::GetColor(color));
+		cached->text.setPosition(sf::Vector2f((float)x, (float)y));
+		cached->string = text_to_draw;
+		cached->x = x;
+		cached->y = y;
+		cached->size = size;
+		cached->color = color;
+	}
+
+	if (cached->string != text_to_draw)
+	{
+		cached->text.setString(text_to_draw);
+		cached->string = text_to_draw;
+	}
+
+	if (cached->size != size)
+	{
+		cached->text.setCharacterSize(size);
+		cached->size = size;
+	}
+
+	if (cached->color != color)
+	{
+		cached->text.setFillColor(IO::GetColor(color));
+		cached->color = color;
+	}
+
+	if (cached->x != x || cached->y != y)
+	{
+		cached->text.setPosition(sf::Vector2f((float)x, (float)y));
+		cached->x = x;
+		cached->y = y;
+	}
+
+	this->window_->draw(cached->text);
 }
 
 int IO::GetScreenWidth() const
@@ -115,14 +192,14 @@ bool IO::WindowIsOpen() const
 	return this->window_->isOpen();
 }
 
-void IO::ClockReset() 
+int64_t IO::ClockGetElapsedTimeUS() const
 {
-	this->clock_.restart();
+	return this->clock_.getElapsedTime().asMicroseconds();
 }
 
-int IO::ClockGetElapsedTimeMS() const
+void IO::Sleep(int us)
 {
-	return this->clock_.getElapsedTime().asMilliseconds();
+	sf::sleep(sf::microseconds(us));
 }
 
 bool IO::PollEvent(IO::Event* event) 
@@ -130,6 +207,7 @@ bool IO::PollEvent(IO::Event* event)
 	sf::Event sf_event;
 	bool res = this->window_->pollEvent(sf_event);
 	*event = IO::GetEvent(sf_event);
+	event->time_us = this->ClockGetElapsedTimeUS();
 	return res;
 }
 
@@ -151,6 +229,8 @@ IO::Event IO::GetEvent(sf::Event event)
 		case sf::Keyboard::Z:		key = IO::eKeyRotate;	break;
 		case sf::Keyboard::X:		key = IO::eKeyDrop;		break;
 		case sf::Keyboard::Escape:	key = IO::eKeyEscape;	break;
+		case sf::Keyboard::F3:		key = IO::eKeyProfiler;	break;
+		case sf::Keyboard::A:		key = IO::eKeyAutoplay;	break;
 		default:					return IO::Event{ IO::EventType::eEventNone };
 		}
 		assert(IO::GetKey(key) == event.key.code);
@@ -9,26 +9,32 @@
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 class IO
 {
 public:
 	enum Color { eBlack, eRed, eGreen, eBlue, eCyan, eMagenta, eYellow, eWhite }; // Colors
-	enum Key { eKeyNone, eKeyRight, eKeyLeft, eKeyUp, eKeyDown, eKeyRotate, eKeyDrop, eKeyEscape };
+	enum Key { eKeyNone, eKeyRight, eKeyLeft, eKeyUp, eKeyDown, eKeyRotate, eKeyDrop, eKeyEscape, eKeyProfiler, eKeyAutoplay };
 	enum EventType { eEventNone, eGameClosed, eKeyPressed };
 
 	struct Event 
 	{
 		EventType type;
 		Key key;
+		int64_t time_us;					// Clock time when the event was read
 	};
 
 	IO();
 
-	void DrawRectangle(int x1, int y1, int x2, int y2, Color color);
-	void DrawText(int x, int y, std::string text_to_draw, int size, Color color);
+	void BeginBatch();
+	void AddQuad(int x1, int y1, int x2, int y2, Color color);
+	void FlushBatch();
+
+	void DrawText(int slot, int x, int y, const std::string& text_to_draw, int size, Color color);
 
 	void ClearScreen ();
 	void UpdateScreen ();
@@ -38,8 +44,8 @@ public:
 	int GetScreenWidth() const;
 	int GetScreenHeight() const;
 
-	void ClockReset();
-	int ClockGetElapsedTimeMS() const;
+	int64_t ClockGetElapsedTimeUS() const;
+	void Sleep(int us);
 
 	bool PollEvent(Event* event);
 
@@ -47,6 +53,16 @@ private:
 	std::unique_ptr<sf::RenderWindow> window_;
 	sf::Clock clock_;
 	sf::Font font_;
+	sf::VertexArray batch_;					// Quads added since BeginBatch, drawn all at once by FlushBatch
+
+	struct CachedText						// Text kept between frames, its glyphs are only laid out again when it changes
+	{
+		sf::Text text;
+		std::string string;
+		int x, y, size;
+		Color color;
+	};
+	std::vector<std::unique_ptr<CachedText>> texts_;	// Indexed by the slot given to DrawText
 
 	static sf::Color GetColor(IO::Color color);
 	static sf::Keyboard::Key GetKey(IO::Key key);
@@ -0,0 +1,292 @@
+/*****************************************************************************************
+/* File: MoveGenerator.cpp
+/* Desc: Every position where the falling piece can be locked, reached with the same moves
+/*       as the player (left, right, down and rotate), so tucks under overhangs and spins are
+/*       found too
+/*****************************************************************************************/
+
+#include "MoveGenerator.h"
+#include "Bits.h"
+#include <cstring>
+
+/* 
+======================================									
+Find every position where the piece can be locked from its current position. The piece is
+moved as GameCore moves it: one block left, right or down, or rotated to the next rotation,
+only to positions where it fits. Positions that fill the same blocks of the board (the
+rotations of the square, for example) are returned once
+
+Parameters:
+
+>> board:		Board where the piece falls
+>> piece:		Falling piece
+>> x:			Horizontal position in blocks
+>> y:			Vertical position in blocks
+>> rotation:	1 of the 4 possible rotations
+
+Returns the number of moves found.
+====================================== 
+*/
+int MoveGenerator::Generate(const Board& board, int piece, int x, int y, int rotation)
+{
+	this->move_count_ = 0;
+	this->start_ = -1;
+
+	int lane = x - Placement::kFirstX;
+	int line = y + Placement::kTopLines;
+	if (lane < 0 || lane >= Placement::kLanes || line < 0 || line >= Placement::kPositions)
+		return 0;
+
+	int first_touch = Placement::GetFreeLanes(board, piece, this->free_lanes_);
+	if ((this->free_lanes_[rotation][line] & (1 << lane)) == 0)
+		return 0;
+
+	this->start_ = (rotation * Placement::kPositions + line) * Placement::kLanes + lane;
+
+	memset(this->reached_, 0, sizeof(this->reached_));
+	if (line < first_touch)
+	{
+		// Above the surface the piece can be moved and rotated everywhere between the walls
+		for (int r = 0; r < Pieces::kRotations; r++)
+			for (int j = line; j < first_touch; j++)
+				this->reached_[r][j] = this->free_lanes_[r][j];
+		this->Flood(first_touch - 1);
+	}
+	else
+	{
+		this->reached_[rotation][line] = (uint16_t) (1 << lane);
+		this->Flood(line);
+	}
+
+	// The piece is locked where it can't move down
+	for (int r = 0; r < Pieces::kRotations; r++)
+	{
+		for (int j = 0; j < Placement::kPositions; j++)
+		{
+			uint16_t below = j + 1 < Placement::kPositions ? this->free_lanes_[r][j + 1] : 0;
+			this->reached_[r][j] &= (uint16_t) ~below;
+		}
+	}
+
+	this->RemoveDuplicates(piece);
+
+	for (int r = 0; r < Pieces::kRotations; r++)
+	{
+		for (int j = 0; j < Placement::kPositions; j++)
+		{
+			for (uint64_t lanes = this->reached_[r][j]; lanes != 0; lanes &= lanes - 1)
+			{
+				Move& move = this->moves_[this->move_count_++];
+				move.x = (int8_t) (Placement::kFirstX + Bits::CountTrailingZeros(lanes));
+				move.y = (int8_t) (j - Placement::kTopLines);
+				move.rotation = (int8_t) r;
+			}
+		}
+	}
+
+	return this->move_count_;
+}
+
+/* 
+======================================									
+Spread the reached positions to every position the piece can be moved to. The moves of all the
+lanes of a line are done at once on the bitmasks; the lines are visited from the top down, so
+the positions reached moving down are spread in the same visit. A rotation is visited again
+only when rotating into it reached new positions
+
+Parameters:
+
+>> line:		First line with reached positions
+====================================== 
+*/
+void MoveGenerator::Flood(int line)
+{
+	// First line of every rotation with reached positions not spread yet
+	int pending[Pieces::kRotations] = { line, line, line, line };
+
+	for (int r = 0, idle = 0; idle < Pieces::kRotations; r = (r + 1) % Pieces::kRotations)
+	{
+		int first = pending[r];
+		if (first == Placement::kPositions)
+		{
+			idle++;
+			continue;
+		}
+		idle = 0;
+		pending[r] = Placement::kPositions;
+
+		int next = (r + 1) % Pieces::kRotations;
+
+		for (int j = first; j < Placement::kPositions; j++)
+		{
+			uint32_t reached = this->reached_[r][j];
+			if (reached == 0)
+				continue;
+
+			// Left and right along the free lanes of the line. When they are contiguous (always above
+			// the surface) all of them are reached, otherwise the reached lanes spread doubling the
+			// distance at every step
+			uint32_t free_lanes = this->free_lanes_[r][j];
+			if ((((free_lanes | (free_lanes - 1)) + 1) & free_lanes) == 0)
+			{
+				reached = free_lanes;
+			}
+			else
+			{
+				uint32_t left = reached;
+				uint32_t right = reached;
+				uint32_t free_left = free_lanes;
+				uint32_t free_right = free_lanes;
+				for (int shift = 1; shift < Placement::kLanes; shift *= 2)
+				{
+					left |= free_left & (left << shift);
+					free_left &= free_left << shift;
+					right |= free_right & (right >> shift);
+					free_right &= free_right >> shift;
+				}
+				reached = left | right;
+			}
+			this->reached_[r][j] = (uint16_t) reached;
+
+			// Down
+			if (j + 1 < Placement::kPositions)
+				this->reached_[r][j + 1] |= (uint16_t) (reached & this->free_lanes_[r][j + 1]);
+
+			// Rotate
+			uint16_t rotated = (uint16_t) (reached & this->free_lanes_[next][j] & ~this->reached_[next][j]);
+			if (rotated != 0)
+			{
+				this->reached_[next][j] |= rotated;
+				if (j < pending[next])
+					pending[next] = j;
+			}
+		}
+	}
+}
+
+/* 
+======================================									
+Remove the final positions of the rotations that fill the same blocks as an earlier rotation,
+where the earlier rotation also has a final position
+====================================== 
+*/
+void MoveGenerator::RemoveDuplicates(int piece)
+{
+	for (int r = 1; r < Pieces::kRotations; r++)
+	{
+		const Pieces::Shape& shape = Pieces::GetShape(piece, r);
+
+		for (int first = 0; first < r; first++)
+		{
+			const Pieces::Shape& same = Pieces::GetShape(piece, first);
+			if (memcmp(shape.rows, same.rows, sizeof(shape.rows)) != 0)
+				continue;
+
+			// Same blocks, the bounding box is at another place in the matrix of the piece
+			int dx = shape.min_x - same.min_x;
+			int dy = shape.min_y - same.min_y;
+
+			for (int j = 0; j < Placement::kPositions; j++)
+			{
+				int k = j + dy;
+				if (k < 0 || k >= Placement::kPositions)
+					continue;
+
+				uint16_t lanes = this->reached_[first][k];
+				lanes = dx >= 0 ? (uint16_t) (lanes >> dx) : (uint16_t) (lanes << -dx);
+				this->reached_[r][j] &= (uint16_t) ~lanes;
+			}
+			break;
+		}
+	}
+}
+
+int MoveGenerator::GetMoveCount() const
+{
+	return this->move_count_;
+}
+
+const MoveGenerator::Move& MoveGenerator::GetMove(int index) const
+{
+	return this->moves_[index];
+}
+
+/* 
+======================================									
+Find the shortest sequence of inputs that moves the piece from where it was when Generate was
+called to one of the moves found. The piece is locked there with a drop (or by the gravity)
+
+Parameters:
+
+>> index:		Move to reach
+>> inputs:		Receives the inputs, in order
+>> max_inputs:	Size of inputs
+
+Returns the number of inputs, -1 if they don't fit in inputs or the move can't be reached.
+====================================== 
+*/
+int MoveGenerator::GetPath(int index, GameCore::Input* inputs, int max_inputs)
+{
+	const Move& move = this->moves_[index];
+	int target = (move.rotation * Placement::kPositions + move.y + Placement::kTopLines) * Placement::kLanes + move.x - Placement::kFirstX;
+
+	memset(this->visited_, 0, sizeof(this->visited_));
+	this->visited_[this->start_ / 64] |= 1ull << (this->start_ % 64);
+	this->queue_[0] = (uint16_t) this->start_;
+
+	int head = 0;
+	int tail = 1;
+	while (head < tail)
+	{
+		int state = this->queue_[head++];
+		if (state == target)
+			break;
+
+		int lane = state % Placement::kLanes;
+		int line = state / Placement::kLanes % Placement::kPositions;
+		int rotation = state / (Placement::kLanes * Placement::kPositions);
+
+		// Same order as GameCore applies the inputs of a step
+		const struct { GameCore::Input input; int lane, line, rotation; } kNeighbours[] =
+		{
+			{ GameCore::eInputLeft, lane - 1, line, rotation },
+			{ GameCore::eInputRight, lane + 1, line, rotation },
+			{ GameCore::eInputRotate, lane, line, (rotation + 1) % Pieces::kRotations },
+			{ GameCore::eInputDown, lane, line + 1, rotation }
+		};
+
+		for (const auto& neighbour : kNeighbours)
+		{
+			if (neighbour.lane < 0 || neighbour.lane >= Placement::kLanes || neighbour.line >= Placement::kPositions)
+				continue;
+			if ((this->free_lanes_[neighbour.rotation][neighbour.line] & (1 << neighbour.lane)) == 0)
+				continue;
+
+			int next = (neighbour.rotation * Placement::kPositions + neighbour.line) * Placement::kLanes + neighbour.lane;
+			if (this->visited_[next / 64] & (1ull << (next % 64)))
+				continue;
+
+			this->visited_[next / 64] |= 1ull << (next % 64);
+			this->parent_[next] = (uint16_t) state;
+			this->input_[next] = (uint8_t) neighbour.input;
+			this->queue_[tail++] = (uint16_t) next;
+		}
+	}
+
+	if ((this->visited_[target / 64] & (1ull << (target % 64))) == 0)
+		return -1;
+
+	// Walk back from the move to the start
+	int length = 0;
+	for (int state = target; state != this->start_; state = this->parent_[state])
+		length++;
+
+	if (length > max_inputs)
+		return -1;
+
+	int i = length;
+	for (int state = target; state != this->start_; state = this->parent_[state])
+		inputs[--i] = (GameCore::Input) this->input_[state];
+
+	return length;
+}
@@ -0,0 +1,55 @@
+/*****************************************************************************************
+/* File: MoveGenerator.h
+/* Desc: Every position where the falling piece can be locked, reached with the same moves
+/*       as the player (left, right, down and rotate), so tucks under overhangs and spins are
+/*       found too
+/*****************************************************************************************/
+
+#ifndef _MOVE_GENERATOR_
+#define _MOVE_GENERATOR_
+
+#include "Board.h"
+#include "GameCore.h"
+#include "Placement.h"
+#include <cstdint>
+
+class MoveGenerator
+{
+public:
+
+	static const int kStates = Pieces::kRotations * Placement::kPositions * Placement::kLanes;
+	static const int kMaxMoves = kStates;		// Every state can be a final position, Generate never drops one
+
+	// Position where the piece is locked, it can't move down from there
+	struct Move
+	{
+		int8_t x;
+		int8_t y;
+		int8_t rotation;
+	};
+
+	int Generate(const Board& board, int piece, int x, int y, int rotation);
+	int GetMoveCount() const;
+	const Move& GetMove(int index) const;
+	int GetPath(int index, GameCore::Input* inputs, int max_inputs);
+
+private:
+
+	uint16_t free_lanes_ [Pieces::kRotations][Placement::kPositions];		// Lanes where the piece fits
+	uint16_t reached_ [Pieces::kRotations][Placement::kPositions];			// Lanes the piece can be moved to
+	Move moves_ [kMaxMoves];
+	int move_count_;
+	int start_;									// State of the piece when Generate was called
+
+	// Breadth first search of GetPath, over the states (rotation, line, lane)
+	uint64_t visited_ [kStates / 64];
+	uint16_t queue_ [kStates];
+	uint16_t parent_ [kStates];
+	uint8_t input_ [kStates];					// Input that moved the piece from the parent to the state
+
+	void Flood(int line);
+	void RemoveDuplicates(int piece);
+
+};
+
+#endif // _MOVE_GENERATOR_
@@ -6,8 +6,330 @@
 #ifndef _PIECES_
 #define _PIECES_
 
+#include <cstdint>
+
 namespace Pieces 
 {
+	const int kPieceKinds = 7;			// Number of different pieces
+	const int kRotations = 4;			// Number of rotations of each piece
+	const int kPieceBlocks = 5;			// Number of horizontal and vertical blocks of a matrix piece
+	const int kPieceCells = 4;			// Number of filled blocks of every piece
+
+	// Matrix of blocks of every piece (0 = no-block, 1 = normal block, 2 = pivot block)
+	inline constexpr char kPieces[kPieceKinds /*kind */][kRotations /* rotation */][kPieceBlocks /* vertical blocks */][kPieceBlocks /* horizontal blocks */] =
+	{
+		// Square
+		  {
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0},
+			{0, 0, 2, 1, 0},
+			{0, 0, 1, 1, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0},
+			{0, 0, 2, 1, 0},
+			{0, 0, 1, 1, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0},
+			{0, 0, 2, 1, 0},
+			{0, 0, 1, 1, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0},
+			{0, 0, 2, 1, 0},
+			{0, 0, 1, 1, 0},
+			{0, 0, 0, 0, 0}
+			}
+		   },
+
+		// I
+		  {
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0},
+			{0, 1, 2, 1, 1},
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 2, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 1, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0},
+			{1, 1, 2, 1, 0},
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 1, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 2, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 0, 0, 0}
+			}
+		   }
+		  ,
+		// L
+		  {
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 2, 0, 0},
+			{0, 0, 1, 1, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0},
+			{0, 1, 2, 1, 0},
+			{0, 1, 0, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 1, 1, 0, 0},
+			{0, 0, 2, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 1, 0},
+			{0, 1, 2, 1, 0},
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0}
+			}
+		   },
+		// L mirrored
+		  {
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 2, 0, 0},
+			{0, 1, 1, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 1, 0, 0, 0},
+			{0, 1, 2, 1, 0},
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 1, 1, 0},
+			{0, 0, 2, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0},
+			{0, 1, 2, 1, 0},
+			{0, 0, 0, 1, 0},
+			{0, 0, 0, 0, 0}
+			}
+		   },
+		// N
+		  {
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 1, 0},
+			{0, 0, 2, 1, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0},
+			{0, 1, 2, 0, 0},
+			{0, 0, 1, 1, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 1, 2, 0, 0},
+			{0, 1, 0, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 1, 1, 0, 0},
+			{0, 0, 2, 1, 0},
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0}
+			}
+		   },
+		// N mirrored
+		  {
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 2, 1, 0},
+			{0, 0, 0, 1, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0},
+			{0, 0, 2, 1, 0},
+			{0, 1, 1, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 1, 0, 0, 0},
+			{0, 1, 2, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 1, 1, 0},
+			{0, 1, 2, 0, 0},
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0}
+			}
+		   },
+		// T
+		  {
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 2, 1, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0},
+			{0, 1, 2, 1, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 1, 2, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 0, 0, 0, 0}
+			},
+		   {
+			{0, 0, 0, 0, 0},
+			{0, 0, 1, 0, 0},
+			{0, 1, 2, 1, 0},
+			{0, 0, 0, 0, 0},
+			{0, 0, 0, 0, 0}
+			}
+		   }
+	};
+
+	// Layout of the filled blocks of a piece in one rotation, precomputed from kPieces.
+	// All the positions are relative to the upper left corner of the 5x5 matrix of the piece
+	struct Shape
+	{
+		int8_t cells_x[kPieceCells] = {};	// Horizontal position of each filled block
+		int8_t cells_y[kPieceCells] = {};	// Vertical position of each filled block
+		uint8_t rows[kPieceCells] = {};		// Occupancy mask of each line of the bounding box from min_y down (bit i = column min_x + i)
+		int8_t bottom[kPieceCells] = {};	// Lowest filled line of each column of the bounding box from min_x, relative to min_y
+		int8_t min_x = 0;					// Bounding box of the filled blocks
+		int8_t max_x = 0;
+		int8_t min_y = 0;
+		int8_t max_y = 0;
+		int8_t pivot_x = 0;					// Position of the pivot block
+		int8_t pivot_y = 0;
+	};
+
+	struct ShapeTable
+	{
+		Shape shapes[kPieceKinds][kRotations];
+	};
+
+	/*
+	======================================
+	Build the shape of a piece in one rotation from its block matrix
+
+	Parameters:
+
+	>> piece:		Piece to build
+	>> rotation:	1 of the 4 possible rotations
+	======================================
+	*/
+	constexpr Shape MakeShape(int piece, int rotation)
+	{
+		Shape shape;
+		shape.min_x = shape.min_y = kPieceBlocks;
+
+		int cell = 0;
+		for (int y = 0; y < kPieceBlocks; y++)
+		{
+			for (int x = 0; x < kPieceBlocks; x++)
+			{
+				char block = kPieces[piece][rotation][y][x];
+				if (block == 0)
+					continue;
+
+				shape.cells_x[cell] = (int8_t) x;
+				shape.cells_y[cell] = (int8_t) y;
+				cell++;
+
+				if (block == 2)
+				{
+					shape.pivot_x = (int8_t) x;
+					shape.pivot_y = (int8_t) y;
+				}
+
+				if (x < shape.min_x) shape.min_x = (int8_t) x;
+				if (x > shape.max_x) shape.max_x = (int8_t) x;
+				if (y < shape.min_y) shape.min_y = (int8_t) y;
+				if (y > shape.max_y) shape.max_y = (int8_t) y;
+			}
+		}
+
+		for (int i = 0; i < kPieceCells; i++)
+		{
+			int column = shape.cells_x[i] - shape.min_x;
+			int line = shape.cells_y[i] - shape.min_y;
+
+			shape.rows[line] |= (uint8_t) (1 << column);
+			if (line > shape.bottom[column])
+				shape.bottom[column] = (int8_t) line;
+		}
+
+		return shape;
+	}
+
+	constexpr ShapeTable MakeShapeTable()
+	{
+		ShapeTable table;
+		for (int piece = 0; piece < kPieceKinds; piece++)
+			for (int rotation = 0; rotation < kRotations; rotation++)
+				table.shapes[piece][rotation] = MakeShape(piece, rotation);
+		return table;
+	}
+
+	inline constexpr ShapeTable kShapes = MakeShapeTable();
+
+	inline const Shape& GetShape(int piece, int rotation)
+	{
+		return kShapes.shapes[piece][rotation];
+	}
+
 	int GetBlockType		(int piece, int rotation, int x, int y);
 	int GetXInitialPosition (int piece, int rotation);
 	int GetYInitialPosition (int piece, int rotation);
@@ -0,0 +1,345 @@
+/*****************************************************************************************
+/* File: Placement.cpp
+/* Desc: Evaluation of every horizontal position and rotation of a piece in one pass. Each
+/*       rotation tests the 16 lanes (horizontal positions) at once with SSE2 or AVX2 on the
+/*       occupancy masks of the lines of the board
+/*****************************************************************************************/
+
+#include "Placement.h"
+#include <assert.h>
+
+#if defined(__AVX2__)
+#define PLACEMENT_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PLACEMENT_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Placement
+{
+	namespace
+	{
+		const uint16_t kWalls = (uint16_t) ~((1 << Board::kBoardWidth) - 1);	// Bits of the columns outside the board
+		const int kLines = kPositions + Pieces::kPieceBlocks;					// Lines above the board, of the board and full lines under it
+
+		static_assert(kTopLines + Board::kBoardHeight + Pieces::kPieceCells <= kLines, "The pieces must always reach the floor");
+
+		static_assert(Board::kBoardWidth < 16, "The walls need free bits in the 16 bit lines");
+
+		// Occupancy mask of every line of the bounding box of a piece in every lane. A piece that
+		// doesn't fit between the walls in a lane has full masks there, so it always collides
+		struct LaneTable
+		{
+			alignas(32) uint16_t masks[Pieces::kPieceKinds][Pieces::kRotations][Pieces::kPieceCells][kLanes] = {};
+			uint16_t inside[Pieces::kPieceKinds][Pieces::kRotations] = {};		// Lanes where the piece is between the walls
+		};
+
+		constexpr LaneTable MakeLaneTable()
+		{
+			LaneTable table;
+			for (int piece = 0; piece < Pieces::kPieceKinds; piece++)
+			{
+				for (int rotation = 0; rotation < Pieces::kRotations; rotation++)
+				{
+					const Pieces::Shape& shape = Pieces::kShapes.shapes[piece][rotation];
+					for (int lane = 0; lane < kLanes; lane++)
+					{
+						int x = kFirstX + lane;
+						bool inside = x + shape.min_x >= 0 && x + shape.max_x < Board::kBoardWidth;
+						if (inside)
+							table.inside[piece][rotation] |= (uint16_t) (1 << lane);
+
+						for (int k = 0; k < Pieces::kPieceCells; k++)
+						{
+							if (shape.rows[k] == 0)
+								continue;
+							table.masks[piece][rotation][k][lane] = inside ? (uint16_t) (shape.rows[k] << (x + shape.min_x)) : (uint16_t) 0xffff;
+						}
+					}
+				}
+			}
+			return table;
+		}
+
+		constexpr LaneTable kLaneTable = MakeLaneTable();
+
+		/* 
+		======================================									
+		Copy the lines of the board with the walls set, between empty lines above it and full
+		lines under it. Returns the first line with blocks
+		====================================== 
+		*/
+		int LoadLines(const Board& board, uint16_t* lines)
+		{
+			for (int j = 0; j < kTopLines; j++)
+				lines[j] = kWalls;
+			for (int j = 0; j < Board::kBoardHeight; j++)
+				lines[kTopLines + j] = board.GetLine(j) | kWalls;
+			for (int j = kTopLines + Board::kBoardHeight; j < kLines; j++)
+				lines[j] = 0xffff;
+
+			int surface = kTopLines;
+			while (lines[surface] == kWalls)
+				surface++;
+			return surface;
+		}
+
+#if defined(PLACEMENT_AVX2)
+
+		// Collision of the piece with the lines from line, one 16 bit lane per horizontal position
+		inline __m256i Collide(const __m256i* masks, const uint16_t* lines, int line)
+		{
+			__m256i collide = _mm256_and_si256(masks[0], _mm256_set1_epi16((short) lines[line]));
+			for (int k = 1; k < Pieces::kPieceCells; k++)
+				collide = _mm256_or_si256(collide, _mm256_and_si256(masks[k], _mm256_set1_epi16((short) lines[line + k])));
+			return collide;
+		}
+
+		void EvaluateRotation(const uint16_t* masks, const uint16_t* lines, int surface, int line, int y, uint16_t* valid, int8_t* landing)
+		{
+			__m256i piece[Pieces::kPieceCells];
+			for (int k = 0; k < Pieces::kPieceCells; k++)
+				piece[k] = _mm256_load_si256((const __m256i*) (masks + k * kLanes));
+
+			__m256i zero = _mm256_setzero_si256();
+			__m256i alive = _mm256_cmpeq_epi16(Collide(piece, lines, line), zero);
+			__m256i rows = _mm256_set1_epi16((short) y);
+
+			__m128i fits = _mm_packs_epi16(_mm256_castsi256_si128(alive), _mm256_extracti128_si256(alive, 1));
+			*valid = (uint16_t) _mm_movemask_epi8(fits);
+
+			// Above the surface nothing collides, the free lanes fall there at once
+			int skip = surface - Pieces::kPieceCells - line;
+			if (skip > 0)
+			{
+				rows = _mm256_add_epi16(rows, _mm256_and_si256(alive, _mm256_set1_epi16((short) skip)));
+				line += skip;
+			}
+
+			// Move the lanes that are still free down until all of them collide, the floor stops them
+			for (line++; !_mm256_testz_si256(alive, alive); line++)
+			{
+				alive = _mm256_and_si256(alive, _mm256_cmpeq_epi16(Collide(piece, lines, line), zero));
+				rows = _mm256_sub_epi16(rows, alive);
+			}
+
+			_mm_storeu_si128((__m128i*) landing, _mm_packs_epi16(_mm256_castsi256_si128(rows), _mm256_extracti128_si256(rows, 1)));
+		}
+
+		void FindFreeLanes(const uint16_t* masks, const uint16_t* lines, int line, int count, uint16_t* free_lanes)
+		{
+			__m256i piece[Pieces::kPieceCells];
+			for (int k = 0; k < Pieces::kPieceCells; k++)
+				piece[k] = _mm256_load_si256((const __m256i*) (masks + k * kLanes));
+
+			__m256i zero = _mm256_setzero_si256();
+			for (int i = 0; i < count; i++)
+			{
+				__m256i fits = _mm256_cmpeq_epi16(Collide(piece, lines, line + i), zero);
+				free_lanes[i] = (uint16_t) _mm_movemask_epi8(_mm_packs_epi16(_mm256_castsi256_si128(fits), _mm256_extracti128_si256(fits, 1)));
+			}
+		}
+
+#elif defined(PLACEMENT_SSE2)
+
+		// Collision of the piece with the lines from line, lanes 0..7 and 8..15
+		inline void Collide(const __m128i* masks, const uint16_t* lines, int line, __m128i* low, __m128i* high)
+		{
+			*low = _mm_setzero_si128();
+			*high = _mm_setzero_si128();
+			for (int k = 0; k < Pieces::kPieceCells; k++)
+			{
+				__m128i row = _mm_set1_epi16((short) lines[line + k]);
+				*low = _mm_or_si128(*low, _mm_and_si128(masks[2 * k], row));
+				*high = _mm_or_si128(*high, _mm_and_si128(masks[2 * k + 1], row));
+			}
+		}
+
+		void EvaluateRotation(const uint16_t* masks, const uint16_t* lines, int surface, int line, int y, uint16_t* valid, int8_t* landing)
+		{
+			__m128i piece[2 * Pieces::kPieceCells];
+			for (int k = 0; k < 2 * Pieces::kPieceCells; k++)
+				piece[k] = _mm_load_si128((const __m128i*) (masks + k * kLanes / 2));
+
+			__m128i zero = _mm_setzero_si128();
+			__m128i low, high;
+			Collide(piece, lines, line, &low, &high);
+			__m128i alive_low = _mm_cmpeq_epi16(low, zero);
+			__m128i alive_high = _mm_cmpeq_epi16(high, zero);
+			__m128i rows_low = _mm_set1_epi16((short) y);
+			__m128i rows_high = rows_low;
+
+			*valid = (uint16_t) _mm_movemask_epi8(_mm_packs_epi16(alive_low, alive_high));
+
+			// Above the surface nothing collides, the free lanes fall there at once
+			int skip = surface - Pieces::kPieceCells - line;
+			if (skip > 0)
+			{
+				__m128i lines_skipped = _mm_set1_epi16((short) skip);
+				rows_low = _mm_add_epi16(rows_low, _mm_and_si128(alive_low, lines_skipped));
+				rows_high = _mm_add_epi16(rows_high, _mm_and_si128(alive_high, lines_skipped));
+				line += skip;
+			}
+
+			// Move the lanes that are still free down until all of them collide, the floor stops them
+			for (line++; _mm_movemask_epi8(_mm_or_si128(alive_low, alive_high)) != 0; line++)
+			{
+				Collide(piece, lines, line, &low, &high);
+				alive_low = _mm_and_si128(alive_low, _mm_cmpeq_epi16(low, zero));
+				alive_high = _mm_and_si128(alive_high, _mm_cmpeq_epi16(high, zero));
+				rows_low = _mm_sub_epi16(rows_low, alive_low);
+				rows_high = _mm_sub_epi16(rows_high, alive_high);
+			}
+
+			_mm_storeu_si128((__m128i*) landing, _mm_packs_epi16(rows_low, rows_high));
+		}
+
+		void FindFreeLanes(const uint16_t* masks, const uint16_t* lines, int line, int count, uint16_t* free_lanes)
+		{
+			__m128i piece[2 * Pieces::kPieceCells];
+			for (int k = 0; k < 2 * Pieces::kPieceCells; k++)
+				piece[k] = _mm_load_si128((const __m128i*) (masks + k * kLanes / 2));
+
+			__m128i zero = _mm_setzero_si128();
+			for (int i = 0; i < count; i++)
+			{
+				__m128i low, high;
+				Collide(piece, lines, line + i, &low, &high);
+				free_lanes[i] = (uint16_t) _mm_movemask_epi8(_mm_packs_epi16(_mm_cmpeq_epi16(low, zero), _mm_cmpeq_epi16(high, zero)));
+			}
+		}
+
+#else
+
+		inline bool Collide(const uint16_t* masks, int lane, const uint16_t* lines, int line)
+		{
+			uint16_t collide = 0;
+			for (int k = 0; k < Pieces::kPieceCells; k++)
+				collide |= masks[k * kLanes + lane] & lines[line + k];
+			return collide != 0;
+		}
+
+		void EvaluateRotation(const uint16_t* masks, const uint16_t* lines, int surface, int line, int y, uint16_t* valid, int8_t* landing)
+		{
+			*valid = 0;
+			for (int lane = 0; lane < kLanes; lane++)
+			{
+				landing[lane] = (int8_t) y;
+				if (Collide(masks, lane, lines, line))
+					continue;
+
+				// Above the surface nothing collides, the piece falls there at once
+				int row = surface - Pieces::kPieceCells > line ? surface - Pieces::kPieceCells : line;
+				while (!Collide(masks, lane, lines, row + 1))
+					row++;
+
+				*valid |= (uint16_t) (1 << lane);
+				landing[lane] = (int8_t) (y + row - line);
+			}
+		}
+
+		void FindFreeLanes(const uint16_t* masks, const uint16_t* lines, int line, int count, uint16_t* free_lanes)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				free_lanes[i] = 0;
+				for (int lane = 0; lane < kLanes; lane++)
+					if (!Collide(masks, lane, lines, line + i))
+						free_lanes[i] |= (uint16_t) (1 << lane);
+			}
+		}
+
+#endif
+	}
+
+	/* 
+	======================================									
+	Check every horizontal position and rotation of a piece at a vertical position, and find
+	where the piece lands in the ones where it fits when it is dropped straight down. Lane i of
+	each rotation is the horizontal position kFirstX + i; it gives the same results as
+	Board::IsPossibleMovement and Board::GetDropPosition
+
+	Parameters:
+
+	>> board:	Board where the piece is placed
+	>> piece:	Piece to place
+	>> y:		Vertical position in blocks, it can be up to 8 blocks above the board
+	>> result:	Receives the valid lanes and the landing positions of every rotation
+	====================================== 
+	*/
+	void Evaluate(const Board& board, int piece, int y, Result* result)
+	{
+		assert(y >= -kTopLines && y < Board::kBoardHeight);
+
+		uint16_t lines[kLines];
+		int surface = LoadLines(board, lines);
+
+		for (int rotation = 0; rotation < Pieces::kRotations; rotation++)
+		{
+			const Pieces::Shape& shape = Pieces::GetShape(piece, rotation);
+			EvaluateRotation(&kLaneTable.masks[piece][rotation][0][0], lines, surface, kTopLines + y + shape.min_y, y,
+				&result->valid[rotation], result->landing[rotation]);
+		}
+	}
+
+	/* 
+	======================================									
+	Find the lanes where a piece fits in every rotation and vertical position: bit i of
+	free_lanes[rotation][j] is set if the piece fits at (kFirstX + i, j - kTopLines). Only the
+	positions that reach the surface of the board are tested, the piece fits above them in every
+	lane between the walls and under the floor in none
+
+	Parameters:
+
+	>> board:		Board where the piece is placed
+	>> piece:		Piece to place
+	>> free_lanes:	Receives the lanes where the piece fits
+
+	Returns the first vertical position (from -kTopLines) where some rotation can touch a block.
+	====================================== 
+	*/
+	int GetFreeLanes(const Board& board, int piece, uint16_t free_lanes[Pieces::kRotations][kPositions])
+	{
+		uint16_t lines[kLines];
+		int surface = LoadLines(board, lines);
+		int first_touch = kPositions;
+
+		for (int rotation = 0; rotation < Pieces::kRotations; rotation++)
+		{
+			const Pieces::Shape& shape = Pieces::GetShape(piece, rotation);
+
+			// Positions where the bounding box of the piece is above the surface
+			int above = surface - Pieces::kPieceCells + 1 - shape.min_y;
+			if (above < 0)
+				above = 0;
+			if (above < first_touch)
+				first_touch = above;
+
+			// Positions where the top of the bounding box is under the floor
+			int below = kTopLines + Board::kBoardHeight - shape.min_y;
+
+			for (int j = 0; j < above; j++)
+				free_lanes[rotation][j] = kLaneTable.inside[piece][rotation];
+
+			FindFreeLanes(&kLaneTable.masks[piece][rotation][0][0], lines, above + shape.min_y, below - above, free_lanes[rotation] + above);
+
+			for (int j = below; j < kPositions; j++)
+				free_lanes[rotation][j] = 0;
+		}
+
+		return first_touch;
+	}
+
+	// Name of the instruction set Evaluate was compiled for
+	const char* GetInstructionSet()
+	{
+#if defined(PLACEMENT_AVX2)
+		return "AVX2";
+#elif defined(PLACEMENT_SSE2)
+		return "SSE2";
+#else
+		return "scalar";
+#endif
+	}
+}
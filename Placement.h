@@ -0,0 +1,33 @@
+/*****************************************************************************************
+/* File: Placement.h
+/* Desc: Evaluation of every horizontal position and rotation of a piece in one pass. Each
+/*       rotation tests the 16 lanes (horizontal positions) at once with SSE2 or AVX2 on the
+/*       occupancy masks of the lines of the board
+/*****************************************************************************************/
+
+#ifndef _PLACEMENT_
+#define _PLACEMENT_
+
+#include "Board.h"
+#include "Pieces.h"
+#include <cstdint>
+
+namespace Placement
+{
+	const int kLanes = 16;				// Horizontal positions evaluated per rotation
+	const int kFirstX = -3;				// Horizontal position of the piece matrix in lane 0
+	const int kTopLines = 8;			// Vertical positions are evaluated from -kTopLines
+	const int kPositions = 32;			// Vertical positions evaluated by GetFreeLanes
+
+	struct Result
+	{
+		uint16_t valid[Pieces::kRotations];					// Bit i set if the piece fits at kFirstX + i
+		int8_t landing[Pieces::kRotations][kLanes];			// Vertical position where the piece lands, only for the valid lanes
+	};
+
+	void Evaluate(const Board& board, int piece, int y, Result* result);
+	int GetFreeLanes(const Board& board, int piece, uint16_t free_lanes[Pieces::kRotations][kPositions]);
+	const char* GetInstructionSet();
+}
+
+#endif // _PLACEMENT_
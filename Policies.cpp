@@ -0,0 +1,101 @@
+/*****************************************************************************************
+/* File: Policies.cpp
+/* Desc: Simple policies that play the pieces of a headless game with the inputs of the
+/*       player, for the benchmarks and the batch runner
+/*****************************************************************************************/
+
+#include "Policies.h"
+#include <cfloat>
+
+namespace
+{
+	const double kGameOverScore = -1e9;
+}
+
+/* 
+======================================									
+Play the current piece with a random number of rotations and a random number of moves to one
+side, then drop it
+
+Parameters:
+
+>> core:		Game to play, the current piece is dropped
+>> random:		Generator of the choices, the same generator plays the same pieces
+====================================== 
+*/
+void Policies::PlayRandomPiece(GameCore& core, Random& random)
+{
+	int rotations = random.NextInt(Pieces::kRotations);
+	int moves = random.NextInt(Board::kBoardWidth / 2 + 1);
+	int direction = random.NextInt(2) == 0 ? GameCore::eInputLeft : GameCore::eInputRight;
+
+	for (int i = 0; i < rotations; i++)
+		core.Step(GameCore::eInputRotate, 0);
+	for (int i = 0; i < moves; i++)
+		core.Step(direction, 0);
+	core.Step(GameCore::eInputDrop, 0);
+}
+
+/* 
+======================================									
+Play the current piece at the best placement of one piece: every number of rotations, then every
+number of moves to one side, where the drop gives the best evaluation. The placements are the
+ones the inputs reach from where the piece is, so the game ends up exactly on the board evaluated
+
+Parameters:
+
+>> core:		Game to play, the current piece is dropped
+>> evaluator:	Score of the boards
+====================================== 
+*/
+void Policies::PlayGreedyPiece(GameCore& core, const Evaluator& evaluator)
+{
+	const Board& board = core.GetBoard();
+	int piece = core.GetPiece();
+	int rotation = core.GetRotation();
+	int x = core.GetPosX();
+	int y = core.GetPosY();
+
+	double best_score = -DBL_MAX;
+	int best_rotations = 0;
+	int best_moves = 0;							// Negative = to the left
+
+	for (int rotations = 0; rotations < Pieces::kRotations; rotations++)
+	{
+		if (rotations > 0)
+		{
+			// The rotations are applied in place, one after the other
+			if (!board.IsPossibleMovement(x, y, piece, (rotation + 1) % 4))
+				break;
+			rotation = (rotation + 1) % 4;
+		}
+
+		for (int direction = -1; direction <= 1; direction += 2)
+		{
+			for (int moves = direction < 0 ? 0 : 1; board.IsPossibleMovement(x + moves * direction, y, piece, rotation); moves++)
+			{
+				int target_x = x + moves * direction;
+
+				Board after = board;
+				after.StorePiece(target_x, after.GetDropPosition(target_x, y, piece, rotation), piece, rotation);
+				int lines = after.DeletePossibleLines();
+				double score = after.IsGameOver() ? kGameOverScore : evaluator.Evaluate(after, lines);
+
+				if (score > best_score)
+				{
+					best_score = score;
+					best_rotations = rotations;
+					best_moves = moves * direction;
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < best_rotations; i++)
+		core.Step(GameCore::eInputRotate, 0);
+	for (int i = 0; i < best_moves; i++)
+		core.Step(GameCore::eInputRight, 0);
+	for (int i = 0; i > best_moves; i--)
+		core.Step(GameCore::eInputLeft, 0);
+	core.Step(GameCore::eInputDrop, 0);
+}
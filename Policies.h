@@ -0,0 +1,20 @@
+/*****************************************************************************************
+/* File: Policies.h
+/* Desc: Simple policies that play the pieces of a headless game with the inputs of the
+/*       player, for the benchmarks and the batch runner
+/*****************************************************************************************/
+
+#ifndef _POLICIES_
+#define _POLICIES_
+
+#include "Evaluator.h"
+#include "GameCore.h"
+#include "Random.h"
+
+namespace Policies
+{
+	void PlayRandomPiece(GameCore& core, Random& random);
+	void PlayGreedyPiece(GameCore& core, const Evaluator& evaluator);
+}
+
+#endif // _POLICIES_
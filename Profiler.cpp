@@ -0,0 +1,163 @@
+/*****************************************************************************************
+/* File: Profiler.cpp
+/* Desc: Timings of the phases of a frame and of the latency of the input, with percentiles
+/*       over the latest samples
+/*****************************************************************************************/
+
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+FrameProfiler::FrameProfiler()
+{
+	for (int i = 0; i < FrameProfiler::ePhaseCount; i++)
+	{
+		this->start_[i] = Clock::now();
+		this->frame_ns_[i] = 0;
+		this->count_[i] = 0;
+		this->total_ns_[i] = 0;
+	}
+	this->first_frame_ = true;
+}
+
+void FrameProfiler::Begin(Phase phase)
+{
+	this->start_[phase] = Clock::now();
+}
+
+/* 
+======================================									
+Add the time elapsed since the Begin of the same phase to the current frame. A phase can run
+several times in a frame, it is recorded once by EndFrame
+====================================== 
+*/
+void FrameProfiler::End(Phase phase)
+{
+	this->frame_ns_[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - this->start_[phase]).count();
+}
+
+/* 
+======================================									
+Record one sample per phase for the frame that ends, and the time since the previous frame ended.
+The first frame only starts the frame timer, the time before it isn't a frame
+====================================== 
+*/
+void FrameProfiler::EndFrame()
+{
+	Clock::time_point now = Clock::now();
+
+	for (int i = 0; i < FrameProfiler::eFrame; i++)
+	{
+		this->Record((Phase) i, this->frame_ns_[i]);
+		this->frame_ns_[i] = 0;
+	}
+
+	if (!this->first_frame_)
+		this->Record(FrameProfiler::eFrame, std::chrono::duration_cast<std::chrono::nanoseconds>(now - this->start_[FrameProfiler::eFrame]).count());
+	this->start_[FrameProfiler::eFrame] = now;
+	this->first_frame_ = false;
+}
+
+/* 
+======================================									
+Record the latency of one input, from the moment it can have been pressed to the moment the game
+state has changed with it
+
+Parameters:
+
+>> us:	Latency in microseconds
+====================================== 
+*/
+void FrameProfiler::RecordInputLatency(int64_t us)
+{
+	this->Record(FrameProfiler::eInputLatency, us * 1000);
+}
+
+void FrameProfiler::Record(Phase phase, int64_t ns)
+{
+	this->window_[phase][this->count_[phase] % FrameProfiler::kWindow] = ns;
+	this->count_[phase]++;
+	this->total_ns_[phase] += ns;
+}
+
+FrameProfiler::Stats FrameProfiler::GetStats(Phase phase) const
+{
+	Stats stats = {};
+	stats.count = this->count_[phase];
+	if (stats.count == 0)
+		return stats;
+
+	int n = (int) std::min<int64_t>(stats.count, FrameProfiler::kWindow);
+	int64_t sorted[FrameProfiler::kWindow];
+	std::copy(this->window_[phase], this->window_[phase] + n, sorted);
+	std::sort(sorted, sorted + n);
+
+	stats.p50 = sorted[(n - 1) * 50 / 100] / 1000.0;
+	stats.p95 = sorted[(n - 1) * 95 / 100] / 1000.0;
+	stats.p99 = sorted[(n - 1) * 99 / 100] / 1000.0;
+	stats.max = sorted[n - 1] / 1000.0;
+	stats.mean = this->total_ns_[phase] / 1000.0 / stats.count;
+	return stats;
+}
+
+/* 
+======================================									
+Returns one line of percentiles per phase, to be drawn on the screen
+====================================== 
+*/
+std::string FrameProfiler::GetReport() const
+{
+	std::string report = "us              p50   p95   p99   max";
+	for (int i = 0; i < FrameProfiler::ePhaseCount; i++)
+	{
+		Stats stats = this->GetStats((Phase) i);
+
+		char line[128];
+		snprintf(line, sizeof(line), "\n%-13s %5.0f %5.0f %5.0f %5.0f",
+			FrameProfiler::GetPhaseName((Phase) i), stats.p50, stats.p95, stats.p99, stats.max);
+		report += line;
+	}
+	return report;
+}
+
+/* 
+======================================									
+Write the statistics of every phase as CSV, so the timings of different builds can be compared
+
+Parameters:
+
+>> path:	File to write, it is overwritten
+
+Returns false if the file can't be written
+====================================== 
+*/
+bool FrameProfiler::WriteReport(const std::string& path) const
+{
+	FILE* file = fopen(path.c_str(), "w");
+	if (file == nullptr)
+		return false;
+
+	fprintf(file, "phase,count,mean_us,p50_us,p95_us,p99_us,max_us\n");
+	for (int i = 0; i < FrameProfiler::ePhaseCount; i++)
+	{
+		Stats stats = this->GetStats((Phase) i);
+		fprintf(file, "%s,%lld,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+			FrameProfiler::GetPhaseName((Phase) i), (long long) stats.count, stats.mean, stats.p50, stats.p95, stats.p99, stats.max);
+	}
+
+	return fclose(file) == 0;
+}
+
+const char* FrameProfiler::GetPhaseName(Phase phase)
+{
+	switch (phase)
+	{
+	case eProcessEvents:	return "ProcessEvents";
+	case eGameLogic:		return "GameLogic";
+	case eDrawScene:		return "DrawScene";
+	case eUpdateScreen:		return "UpdateScreen";
+	case eFrame:			return "Frame";
+	case eInputLatency:		return "InputLatency";
+	default:				return "?";
+	}
+}
@@ -0,0 +1,57 @@
+/*****************************************************************************************
+/* File: Profiler.h
+/* Desc: Timings of the phases of a frame and of the latency of the input, with percentiles
+/*       over the latest samples
+/*****************************************************************************************/
+
+#ifndef _PROFILER_
+#define _PROFILER_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+class FrameProfiler
+{
+public:
+
+	// eInputLatency is not a phase: it is sampled once per input applied to the game, not once per frame
+	enum Phase { eProcessEvents, eGameLogic, eDrawScene, eUpdateScreen, eFrame, eInputLatency, ePhaseCount };
+
+	struct Stats							// Microseconds
+	{
+		double p50, p95, p99, max;
+		double mean;						// Over the whole run
+		int64_t count;						// Number of samples over the whole run
+	};
+
+	static const int kWindow = 512;			// Number of latest samples used for the percentiles
+
+	FrameProfiler();
+
+	void Begin(Phase phase);
+	void End(Phase phase);
+	void EndFrame();
+	void RecordInputLatency(int64_t us);
+
+	Stats GetStats(Phase phase) const;
+	std::string GetReport() const;
+	bool WriteReport(const std::string& path) const;
+
+	static const char* GetPhaseName(Phase phase);
+
+private:
+
+	typedef std::chrono::steady_clock Clock;
+
+	Clock::time_point start_[ePhaseCount];
+	int64_t frame_ns_[ePhaseCount];			// Time of every phase in the current frame
+	bool first_frame_;						// No frame has ended yet, the time of the frame is unknown
+	int64_t window_[ePhaseCount][kWindow];	// Ring buffer of the latest samples in nanoseconds
+	int64_t count_[ePhaseCount];
+	int64_t total_ns_[ePhaseCount];
+
+	void Record(Phase phase, int64_t ns);
+};
+
+#endif // _PROFILER_
@@ -0,0 +1,99 @@
+/*****************************************************************************************
+/* File: Random.h
+/* Desc: Seedable pseudo random number generator (xoshiro256**). Every game owns its own
+/*       generator, so games are reproducible from their seed and can run in parallel
+/*****************************************************************************************/
+
+#ifndef _RANDOM_
+#define _RANDOM_
+
+#include <cstdint>
+
+class Random
+{
+public:
+
+	explicit Random(uint64_t seed = 0)
+	{
+		this->Seed(seed);
+	}
+
+	/* 
+	======================================									
+	Restart the sequence. The four words of state are expanded from the seed with splitmix64,
+	so any seed (including 0) gives a valid state
+	====================================== 
+	*/
+	void Seed(uint64_t seed)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			seed += 0x9e3779b97f4a7c15ull;
+			this->state_[i] = Random::Mix(seed);
+		}
+	}
+
+	// Hash of the four words of state: generators with the same state give the same numbers
+	uint64_t GetHash() const
+	{
+		uint64_t hash = 0;
+		for (int i = 0; i < 4; i++)
+			hash = Random::Mix(hash ^ this->state_[i]);
+		return hash;
+	}
+
+	uint64_t NextU64()
+	{
+		uint64_t result = Random::Rotl(this->state_[1] * 5, 7) * 9;
+		uint64_t t = this->state_[1] << 17;
+
+		this->state_[2] ^= this->state_[0];
+		this->state_[3] ^= this->state_[1];
+		this->state_[1] ^= this->state_[2];
+		this->state_[0] ^= this->state_[3];
+		this->state_[2] ^= t;
+		this->state_[3] = Random::Rotl(this->state_[3], 45);
+
+		return result;
+	}
+
+	/* 
+	======================================									
+	Returns an unbiased random int in [0, n) (Lemire's multiply and reject method)
+	====================================== 
+	*/
+	int NextInt(int n)
+	{
+		uint64_t product = (this->NextU64() >> 32) * (uint32_t) n;
+		uint32_t low = (uint32_t) product;
+		if (low < (uint32_t) n)
+		{
+			uint32_t threshold = (uint32_t) -n % (uint32_t) n;
+			while (low < threshold)
+			{
+				product = (this->NextU64() >> 32) * (uint32_t) n;
+				low = (uint32_t) product;
+			}
+		}
+		return (int) (product >> 32);
+	}
+
+private:
+
+	uint64_t state_[4];
+
+	// Finalizer of splitmix64
+	static uint64_t Mix(uint64_t z)
+	{
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	static uint64_t Rotl(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+};
+
+#endif // _RANDOM_
@@ -0,0 +1,347 @@
+/*****************************************************************************************
+/* File: Randomizer.cpp
+/* Desc: Generators of the sequence of pieces (pure random, bags, TGM history) and the queue
+/*       of upcoming pieces that they fill
+/*****************************************************************************************/
+
+#include "Randomizer.h"
+#include "Zobrist.h"
+#include <assert.h>
+#include <cmath>
+
+std::unique_ptr<Randomizer> Randomizer::Create(Type type)
+{
+	switch (type)
+	{
+	case ePure:		return std::make_unique<PureRandomizer>();
+	case eBag7:		return std::make_unique<BagRandomizer>(1);
+	case eBag14:	return std::make_unique<BagRandomizer>(2);
+	case eHistory:	return std::make_unique<HistoryRandomizer>(4);
+	default:		assert(false); return nullptr;
+	}
+}
+
+void PureRandomizer::Reset()
+{
+}
+
+int PureRandomizer::NextPiece(Random* random)
+{
+	return random->NextInt(Pieces::kPieceKinds);
+}
+
+uint64_t PureRandomizer::GetState() const
+{
+	return 0;
+}
+
+void PureRandomizer::GetOdds(uint64_t /*state*/, double odds[Pieces::kPieceKinds]) const
+{
+	for (int piece = 0; piece < Pieces::kPieceKinds; piece++)
+		odds[piece] = 1.0 / Pieces::kPieceKinds;
+}
+
+uint64_t PureRandomizer::Deal(uint64_t state, int /*piece*/) const
+{
+	return state;
+}
+
+/* 
+======================================									
+Parameters:
+
+>> copies:	How many times every kind of piece is in the bag (1 = 7-bag, 2 = 14-bag)
+====================================== 
+*/
+BagRandomizer::BagRandomizer(int copies)
+{
+	assert(copies >= 1 && copies <= BagRandomizer::kMaxCopies);
+
+	this->size_ = Pieces::kPieceKinds * copies;
+	this->Reset();
+}
+
+void BagRandomizer::Reset()
+{
+	this->remaining_ = 0;
+}
+
+int BagRandomizer::NextPiece(Random* random)
+{
+	// Refill the bag when it is empty
+	if (this->remaining_ == 0)
+	{
+		for (int i = 0; i < this->size_; i++)
+			this->bag_[i] = i % Pieces::kPieceKinds;
+		this->remaining_ = this->size_;
+	}
+
+	// Take a random piece of the bag and fill its place with the last one
+	int i = random->NextInt(this->remaining_);
+	int piece = this->bag_[i];
+	this->bag_[i] = this->bag_[--this->remaining_];
+	return piece;
+}
+
+uint64_t BagRandomizer::GetState() const
+{
+	return BagRandomizer::Pack(this->bag_, this->remaining_);
+}
+
+/* 
+======================================									
+Probability of every kind of piece of being the next one: the share of the kind in the pieces
+left in the bag, or in a full bag if it is empty
+
+Parameters:
+
+>> state:	Memory of the bag, from GetState or Deal
+>> odds:	Receives the probability of every kind of piece
+====================================== 
+*/
+void BagRandomizer::GetOdds(uint64_t state, double odds[Pieces::kPieceKinds]) const
+{
+	int bag[Pieces::kPieceKinds * BagRandomizer::kMaxCopies];
+	int remaining = BagRandomizer::Unpack(state, bag);
+
+	for (int piece = 0; piece < Pieces::kPieceKinds; piece++)
+		odds[piece] = remaining == 0 ? 1.0 / Pieces::kPieceKinds : 0.0;
+	for (int i = 0; i < remaining; i++)
+		odds[bag[i]] += 1.0 / remaining;
+}
+
+/* 
+======================================									
+Returns the memory of the bag once a piece is dealt from it. The piece leaves the bag like in
+NextPiece, its place is filled with the last piece
+
+Parameters:
+
+>> state:	Memory of the bag, from GetState or Deal
+>> piece:	Piece dealt, one of the bag (GetOdds gives it a probability over 0)
+====================================== 
+*/
+uint64_t BagRandomizer::Deal(uint64_t state, int piece) const
+{
+	int bag[Pieces::kPieceKinds * BagRandomizer::kMaxCopies];
+	int remaining = BagRandomizer::Unpack(state, bag);
+
+	if (remaining == 0)
+	{
+		for (int i = 0; i < this->size_; i++)
+			bag[i] = i % Pieces::kPieceKinds;
+		remaining = this->size_;
+	}
+
+	int i = 0;
+	while (i < remaining - 1 && bag[i] != piece)
+		i++;
+	assert(bag[i] == piece);
+
+	bag[i] = bag[--remaining];
+	return BagRandomizer::Pack(bag, remaining);
+}
+
+// The pieces left in the bag in order (the draws pick them by index), 3 bits each, then their number
+uint64_t BagRandomizer::Pack(const int* bag, int remaining)
+{
+	static_assert(Pieces::kPieceKinds * BagRandomizer::kMaxCopies * 3 + 5 <= 64, "The bag doesn't fit in the state");
+
+	uint64_t state = 0;
+	for (int i = 0; i < remaining; i++)
+		state = (state << 3) | (uint64_t) bag[i];
+	return (state << 5) | (uint64_t) remaining;
+}
+
+// Returns the number of pieces left in the bag of a state, and fills bag with them
+int BagRandomizer::Unpack(uint64_t state, int* bag)
+{
+	int remaining = (int) (state & 31);
+	for (int i = remaining - 1; i >= 0; i--)
+		bag[i] = (int) ((state >> (5 + 3 * (remaining - 1 - i))) & 7);
+	return remaining;
+}
+
+/* 
+======================================									
+Parameters:
+
+>> rolls:	Maximum number of draws for every piece
+====================================== 
+*/
+HistoryRandomizer::HistoryRandomizer(int rolls)
+{
+	assert(rolls >= 1);
+
+	this->rolls_ = rolls;
+	this->Reset();
+}
+
+void HistoryRandomizer::Reset()
+{
+	// The history starts full of N pieces, so the first piece is unlikely to be one of them
+	for (int i = 0; i < HistoryRandomizer::kHistorySize; i++)
+		this->history_[i] = (i % 2 == 0) ? 4 : 5;
+}
+
+int HistoryRandomizer::NextPiece(Random* random)
+{
+	int piece = 0;
+	for (int roll = 0; roll < this->rolls_; roll++)
+	{
+		piece = random->NextInt(Pieces::kPieceKinds);
+
+		bool in_history = false;
+		for (int i = 0; i < HistoryRandomizer::kHistorySize; i++)
+			in_history = in_history || this->history_[i] == piece;
+
+		if (!in_history)
+			break;
+	}
+
+	for (int i = HistoryRandomizer::kHistorySize - 1; i > 0; i--)
+		this->history_[i] = this->history_[i - 1];
+	this->history_[0] = piece;
+
+	return piece;
+}
+
+// The last pieces dealt, 3 bits each, the newest one in the highest bits
+uint64_t HistoryRandomizer::GetState() const
+{
+	uint64_t state = 0;
+	for (int i = 0; i < HistoryRandomizer::kHistorySize; i++)
+		state = (state << 3) | (uint64_t) this->history_[i];
+	return state;
+}
+
+/* 
+======================================									
+Probability of every kind of piece of being the next one. A kind out of the history comes from
+the first roll that misses the history; a kind of the history only from the last roll, once
+all the others have hit the history
+
+Parameters:
+
+>> state:	Memory of the history, from GetState or Deal
+>> odds:	Receives the probability of every kind of piece
+====================================== 
+*/
+void HistoryRandomizer::GetOdds(uint64_t state, double odds[Pieces::kPieceKinds]) const
+{
+	bool in_history[Pieces::kPieceKinds] = {};
+	for (int i = 0; i < HistoryRandomizer::kHistorySize; i++)
+		in_history[(state >> (3 * i)) & 7] = true;
+
+	int kinds_in = 0;
+	for (int piece = 0; piece < Pieces::kPieceKinds; piece++)
+		kinds_in += in_history[piece] ? 1 : 0;
+
+	double hit = (double) kinds_in / Pieces::kPieceKinds;
+	double last_roll = std::pow(hit, this->rolls_ - 1);
+	for (int piece = 0; piece < Pieces::kPieceKinds; piece++)
+	{
+		if (in_history[piece])
+			odds[piece] = last_roll / Pieces::kPieceKinds;
+		else
+			odds[piece] = (1.0 - last_roll * hit) / (Pieces::kPieceKinds - kinds_in);
+	}
+}
+
+// Returns the memory of the history once a piece is dealt: the piece is the newest, the oldest is forgotten
+uint64_t HistoryRandomizer::Deal(uint64_t state, int piece) const
+{
+	return ((uint64_t) piece << (3 * (HistoryRandomizer::kHistorySize - 1))) | (state >> 3);
+}
+
+PieceQueue::PieceQueue(Randomizer::Type type)
+{
+	this->randomizer_ = Randomizer::Create(type);
+	this->Reset(0);
+}
+
+/* 
+======================================									
+Restart the sequence of pieces, the same seed always gives the same sequence
+
+Parameters:
+
+>> seed:	Seed of the random number generator
+====================================== 
+*/
+void PieceQueue::Reset(uint64_t seed)
+{
+	this->random_.Seed(seed);
+	this->randomizer_->Reset();
+
+	this->head_ = 0;
+	for (int i = 0; i < PieceQueue::kLookahead; i++)
+	{
+		this->states_[i] = this->randomizer_->GetState();
+		this->entries_[i] = this->Generate();
+	}
+}
+
+PieceQueue::Entry PieceQueue::Generate()
+{
+	Entry entry;
+	entry.piece = this->randomizer_->NextPiece(&this->random_);
+	entry.rotation = this->random_.NextInt(Pieces::kRotations);
+	return entry;
+}
+
+/* 
+======================================									
+Take the next piece out of the queue and generate a new one at the end
+====================================== 
+*/
+PieceQueue::Entry PieceQueue::Pop()
+{
+	Entry entry = this->entries_[this->head_];
+	this->states_[this->head_] = this->randomizer_->GetState();
+	this->entries_[this->head_] = this->Generate();
+	this->head_ = (this->head_ + 1) % PieceQueue::kLookahead;
+	return entry;
+}
+
+const PieceQueue::Entry& PieceQueue::Peek(int i) const
+{
+	assert(i >= 0 && i < PieceQueue::kLookahead);
+
+	return this->entries_[(this->head_ + i) % PieceQueue::kLookahead];
+}
+
+const Randomizer& PieceQueue::GetRandomizer() const
+{
+	return *this->randomizer_;
+}
+
+/* 
+======================================									
+Returns the state of the randomizer after the pieces before an entry of the queue: what a player
+who has seen these pieces knows of the next ones, without the entry itself
+
+Parameters:
+
+>> i:	Entry of the queue, i = kLookahead is the piece after the queue
+====================================== 
+*/
+uint64_t PieceQueue::GetRandomizerState(int i) const
+{
+	assert(i >= 0 && i <= PieceQueue::kLookahead);
+
+	if (i == PieceQueue::kLookahead)
+		return this->randomizer_->GetState();
+	return this->states_[(this->head_ + i) % PieceQueue::kLookahead];
+}
+
+/* 
+======================================									
+Returns the hash of what generates the pieces after the queue: the state of the random number
+generator and the memory of the randomizer
+====================================== 
+*/
+uint64_t PieceQueue::GetGeneratorHash() const
+{
+	return Zobrist::SplitMix(this->random_.GetHash() ^ this->randomizer_->GetState());
+}
@@ -0,0 +1,125 @@
+/*****************************************************************************************
+/* File: Randomizer.h
+/* Desc: Generators of the sequence of pieces (pure random, bags, TGM history) and the queue
+/*       of upcoming pieces that they fill
+/*****************************************************************************************/
+
+#ifndef _RANDOMIZER_
+#define _RANDOMIZER_
+
+#include "Pieces.h"
+#include "Random.h"
+#include <cstdint>
+#include <memory>
+
+class Randomizer
+{
+public:
+
+	enum Type { ePure, eBag7, eBag14, eHistory };
+
+	virtual ~Randomizer() {}
+
+	virtual void Reset() = 0;							// Forget the pieces already generated
+	virtual int NextPiece(Random* random) = 0;			// Kind of the next piece of the sequence
+	virtual uint64_t GetState() const = 0;				// Memory of the pieces already generated, packed in 64 bits
+
+	// The same memory, out of the randomizer: what comes next after a state, and the state after a piece
+	virtual void GetOdds(uint64_t state, double odds[Pieces::kPieceKinds]) const = 0;
+	virtual uint64_t Deal(uint64_t state, int piece) const = 0;
+
+	static std::unique_ptr<Randomizer> Create(Type type);
+};
+
+// Every piece is drawn independently with the same probability
+class PureRandomizer : public Randomizer
+{
+public:
+
+	void Reset() override;
+	int NextPiece(Random* random) override;
+	uint64_t GetState() const override;
+	void GetOdds(uint64_t state, double odds[Pieces::kPieceKinds]) const override;
+	uint64_t Deal(uint64_t state, int piece) const override;
+};
+
+// The pieces are dealt from a shuffled bag that holds every kind of piece a number of times
+class BagRandomizer : public Randomizer
+{
+public:
+
+	explicit BagRandomizer(int copies);
+
+	void Reset() override;
+	int NextPiece(Random* random) override;
+	uint64_t GetState() const override;
+	void GetOdds(uint64_t state, double odds[Pieces::kPieceKinds]) const override;
+	uint64_t Deal(uint64_t state, int piece) const override;
+
+	static const int kMaxCopies = 2;
+
+private:
+
+	int bag_[Pieces::kPieceKinds * kMaxCopies];
+	int size_;									// Number of pieces in a full bag
+	int remaining_;								// Pieces not dealt yet, they are the first ones of bag_
+
+	static uint64_t Pack(const int* bag, int remaining);
+	static int Unpack(uint64_t state, int* bag);
+};
+
+// TGM randomizer: a piece is rerolled a few times while it is one of the last pieces dealt
+class HistoryRandomizer : public Randomizer
+{
+public:
+
+	explicit HistoryRandomizer(int rolls);
+
+	void Reset() override;
+	int NextPiece(Random* random) override;
+	uint64_t GetState() const override;
+	void GetOdds(uint64_t state, double odds[Pieces::kPieceKinds]) const override;
+	uint64_t Deal(uint64_t state, int piece) const override;
+
+	static const int kHistorySize = 4;
+
+private:
+
+	int history_[kHistorySize];
+	int rolls_;
+};
+
+// Queue of the upcoming pieces, each one with the rotation it will appear with
+class PieceQueue
+{
+public:
+
+	struct Entry
+	{
+		int piece;
+		int rotation;
+	};
+
+	static const int kLookahead = 6;			// Number of upcoming pieces known in advance
+
+	explicit PieceQueue(Randomizer::Type type);
+
+	void Reset(uint64_t seed);
+	Entry Pop();
+	const Entry& Peek(int i) const;				// i = 0 is the next piece
+	const Randomizer& GetRandomizer() const;
+	uint64_t GetRandomizerState(int i) const;
+	uint64_t GetGeneratorHash() const;
+
+private:
+
+	Random random_;
+	std::unique_ptr<Randomizer> randomizer_;
+	Entry entries_[kLookahead];					// Ring buffer of the upcoming pieces
+	uint64_t states_[kLookahead];				// State of the randomizer before every entry was generated
+	int head_;
+
+	Entry Generate();
+};
+
+#endif // _RANDOMIZER_
@@ -0,0 +1,427 @@
+/*****************************************************************************************
+/* File: ThreadPool.cpp
+/* Desc: Work stealing pool of worker threads shared by the bots, the headless games and the
+/*       benchmarks, and the task groups that fork jobs on it and join them
+/*****************************************************************************************/
+
+#include "ThreadPool.h"
+#include <algorithm>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+	const int kSpins = 64;						// Rounds of stealing before a worker goes to sleep
+
+	// Worker of the thread, set by the threads of the pools
+	thread_local const ThreadPool* current_pool = nullptr;
+	thread_local int current_worker = 0;
+
+	// Settings of the global pool, until it is created
+	int global_threads = 0;
+	bool global_pin_threads = false;
+}
+
+/* 
+======================================									
+Parameters:
+
+>> threads:		Number of workers, including the thread out of the pool that gives it work. 0 = one
+				per hardware thread
+>> pin_threads:	Run every worker on its own CPU
+====================================== 
+*/
+ThreadPool::ThreadPool(int threads, bool pin_threads)
+{
+	if (threads <= 0)
+		threads = (int) std::thread::hardware_concurrency();
+	if (threads <= 0)
+		threads = 1;
+
+	this->epoch_ = 0;
+	this->sleeping_ = 0;
+	this->stop_ = false;
+	this->injected_.reserve(JobDeque::kCapacity);
+	this->injected_count_ = 0;
+
+	this->deques_.push_back(nullptr);
+	for (int worker = 1; worker < threads; worker++)
+		this->deques_.push_back(std::make_unique<JobDeque>());
+
+	// Worker 0 is the thread that gives work to the pool, it runs its jobs while it waits for them
+	int cpus = std::max(1, (int) std::thread::hardware_concurrency());
+	for (int worker = 1; worker < threads; worker++)
+	{
+		this->threads_.emplace_back(&ThreadPool::WorkerLoop, this, worker);
+		if (pin_threads)
+			ThreadPool::PinThread(&this->threads_.back(), worker % cpus);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		this->stop_ = true;
+	}
+	this->wake_.notify_all();
+
+	for (std::thread& thread : this->threads_)
+		thread.join();
+}
+
+int ThreadPool::GetWorkerCount() const
+{
+	return (int) this->deques_.size();
+}
+
+// Worker of the calling thread. The threads out of the pool are all worker 0: any of them can give
+// work to the pool, but data indexed by the worker must be used by one of them at a time
+int ThreadPool::GetCurrentWorker() const
+{
+	return current_pool == this ? current_worker : 0;
+}
+
+/* 
+======================================									
+Pool shared by the whole program, created the first time it is used
+====================================== 
+*/
+ThreadPool& ThreadPool::GetGlobal()
+{
+	static ThreadPool pool(global_threads, global_pin_threads);
+	return pool;
+}
+
+/* 
+======================================									
+Set how the global pool is created. It has to be called before the pool is first used
+
+Parameters:
+
+>> threads:		Number of workers (0 = one per hardware thread)
+>> pin_threads:	Run every worker on its own CPU
+====================================== 
+*/
+void ThreadPool::SetGlobalThreads(int threads, bool pin_threads)
+{
+	global_threads = threads;
+	global_pin_threads = pin_threads;
+}
+
+/* 
+======================================									
+Run task(worker, i) for every i in 0..count-1, on every worker, and return when all of them are
+done. The iterations are handed out one at a time, so they can take different times. Loops can
+be run from the iterations of other loops. A loop doesn't allocate memory if its task doesn't
+
+Parameters:
+
+>> count:	Number of iterations
+>> task:	Iteration, it gets the worker (0..GetWorkerCount()-1) so it can use data of its own
+====================================== 
+*/
+void ThreadPool::ParallelFor(int count, const Task& task)
+{
+	if (count <= 0)
+		return;
+
+	if (this->threads_.empty() || count == 1)
+	{
+		int worker = this->GetCurrentWorker();
+		for (int i = 0; i < count; i++)
+			task(worker, i);
+		return;
+	}
+
+	// Every job takes iterations until there are none left, the idle workers steal the jobs
+	std::atomic<int> next(0);
+	auto run_iterations = [this, count, &task, &next]() {
+		int worker = this->GetCurrentWorker();
+		for (int i = next++; i < count; i = next++)
+			task(worker, i);
+	};
+
+	// The helpers all run the same job, on the stack
+	TaskGroup group(*this);
+	Job job{ std::ref(run_iterations), &group, false };
+	int helpers = std::min(count, this->GetWorkerCount()) - 1;
+	for (int i = 0; i < helpers; i++)
+	{
+		group.pending_++;
+		this->Submit(&job);
+	}
+
+	run_iterations();
+	group.Wait();
+}
+
+// Give a job to the workers, on the deque of the calling worker or in the bag of the threads out of the pool
+void ThreadPool::Submit(Job* job)
+{
+	int worker = this->GetCurrentWorker();
+	bool queued = worker != 0 ? this->deques_[worker]->Push(job) : this->Inject(job);
+	if (!queued)
+	{
+		// The deque is full: the job runs now
+		ThreadPool::Execute(job);
+		return;
+	}
+
+	this->epoch_++;
+	if (this->sleeping_ > 0)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		this->wake_.notify_one();
+	}
+}
+
+// Returns false if the bag of the threads out of the pool is full
+bool ThreadPool::Inject(Job* job)
+{
+	std::lock_guard<std::mutex> lock(this->injected_mutex_);
+	if ((int) this->injected_.size() == JobDeque::kCapacity)
+		return false;
+
+	this->injected_.push_back(job);
+	this->injected_count_++;
+	return true;
+}
+
+// Take a job of the threads out of the pool, of one group only unless group is null
+ThreadPool::Job* ThreadPool::TakeInjected(const TaskGroup* group)
+{
+	if (this->injected_count_ == 0)
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock(this->injected_mutex_);
+	for (size_t i = 0; i < this->injected_.size(); i++)
+	{
+		Job* job = this->injected_[i];
+		if (group != nullptr && job->group != group)
+			continue;
+
+		this->injected_[i] = this->injected_.back();
+		this->injected_.pop_back();
+		this->injected_count_--;
+		return job;
+	}
+	return nullptr;
+}
+
+/* 
+======================================									
+Run a job of the worker, or else one of the threads out of the pool, or else one stolen from
+another worker. The threads out of the pool only run the jobs of the group they wait for: they
+are all worker 0, two of them must not run the jobs of the same loop
+
+Parameters:
+
+>> worker:	Worker of the calling thread
+>> group:	Group the thread waits for, nullptr for the workers of the pool
+
+Returns false if there was no job to run.
+====================================== 
+*/
+bool ThreadPool::RunJob(int worker, const TaskGroup* group)
+{
+	Job* job = nullptr;
+	if (worker == 0)
+	{
+		job = this->TakeInjected(group);
+	}
+	else
+	{
+		job = this->deques_[worker]->Pop();
+		if (job == nullptr)
+			job = this->TakeInjected(nullptr);
+
+		int workers = this->GetWorkerCount();
+		for (int i = 1; i < workers && job == nullptr; i++)
+		{
+			int victim = (worker + i) % workers;
+			if (victim != 0)
+				job = this->deques_[victim]->Steal();
+		}
+	}
+
+	if (job == nullptr)
+		return false;
+
+	ThreadPool::Execute(job);
+	return true;
+}
+
+// Run a job and count it done in its group. A job of the caller can be gone once it is counted
+void ThreadPool::Execute(Job* job)
+{
+	job->function();
+
+	TaskGroup* group = job->group;
+	if (job->owned)
+		delete job;
+	group->pending_--;
+}
+
+void ThreadPool::WorkerLoop(int worker)
+{
+	current_pool = this;
+	current_worker = worker;
+
+	while (!this->stop_)
+	{
+		bool found = false;
+		for (int spin = 0; spin < kSpins && !found; spin++)
+		{
+			found = this->RunJob(worker, nullptr);
+			if (!found)
+				std::this_thread::yield();
+		}
+		if (found)
+			continue;
+
+		// Sleep until a job is submitted. The epoch is read before looking for jobs a last time, a
+		// job submitted after that changes it
+		uint64_t epoch = this->epoch_;
+		this->sleeping_++;
+		if (!this->RunJob(worker, nullptr))
+		{
+			std::unique_lock<std::mutex> lock(this->mutex_);
+			this->wake_.wait(lock, [&]() { return this->stop_ || this->epoch_ != epoch; });
+		}
+		this->sleeping_--;
+	}
+}
+
+// Keep a worker on one CPU, so the workers don't move from cache to cache
+void ThreadPool::PinThread(std::thread* thread, int cpu)
+{
+#if defined(_WIN32)
+	if (cpu < 64)
+		SetThreadAffinityMask(thread->native_handle(), (DWORD_PTR) 1 << cpu);
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	pthread_setaffinity_np(thread->native_handle(), sizeof(set), &set);
+#else
+	(void) thread;
+	(void) cpu;
+#endif
+}
+
+ThreadPool::JobDeque::JobDeque()
+{
+	this->top_ = 0;
+	this->bottom_ = 0;
+	for (std::atomic<Job*>& job : this->jobs_)
+		job.store(nullptr, std::memory_order_relaxed);
+}
+
+// Owner only. Returns false if the deque is full
+bool ThreadPool::JobDeque::Push(Job* job)
+{
+	int64_t bottom = this->bottom_.load(std::memory_order_relaxed);
+	int64_t top = this->top_.load(std::memory_order_acquire);
+	if (bottom - top >= JobDeque::kCapacity)
+		return false;
+
+	// The job is written before the thieves can see it
+	this->jobs_[bottom % JobDeque::kCapacity].store(job, std::memory_order_relaxed);
+	this->bottom_.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+// Owner only: the newest job
+ThreadPool::Job* ThreadPool::JobDeque::Pop()
+{
+	// The bottom is taken before the top is read, a thief reading the bottom afterwards leaves the job
+	int64_t bottom = this->bottom_.load(std::memory_order_relaxed) - 1;
+	this->bottom_.store(bottom, std::memory_order_seq_cst);
+	int64_t top = this->top_.load(std::memory_order_seq_cst);
+
+	if (top > bottom)
+	{
+		this->bottom_.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = this->jobs_[bottom % JobDeque::kCapacity].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		// Last job: a thief may be taking it too
+		if (!this->top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+		this->bottom_.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+// Any worker: the oldest job
+ThreadPool::Job* ThreadPool::JobDeque::Steal()
+{
+	int64_t top = this->top_.load(std::memory_order_seq_cst);
+	int64_t bottom = this->bottom_.load(std::memory_order_seq_cst);
+
+	if (top >= bottom)
+		return nullptr;
+
+	Job* job = this->jobs_[top % JobDeque::kCapacity].load(std::memory_order_relaxed);
+	if (!this->top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr;
+	return job;
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool)
+	: pool_(pool), pending_(0)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+	this->Wait();
+}
+
+/* 
+======================================									
+Fork a job. It runs on any worker of the pool, or on the thread that waits for the group
+
+Parameters:
+
+>> function:	Job to run
+====================================== 
+*/
+void TaskGroup::Run(std::function<void()> function)
+{
+	this->pending_++;
+	this->pool_.Submit(new ThreadPool::Job{ std::move(function), this, true });
+}
+
+// True when every job forked has finished, without waiting for them. Their writes are visible then
+bool TaskGroup::IsDone() const
+{
+	return this->pending_ == 0;
+}
+
+/* 
+======================================									
+Join the jobs of the group. A worker runs the jobs of the pool until they are done, its own ones
+first; a thread out of the pool runs the jobs of the group that are not taken yet
+====================================== 
+*/
+void TaskGroup::Wait()
+{
+	int worker = this->pool_.GetCurrentWorker();
+	while (this->pending_ > 0)
+	{
+		if (!this->pool_.RunJob(worker, this))
+			std::this_thread::yield();
+	}
+}
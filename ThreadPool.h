@@ -0,0 +1,122 @@
+/*****************************************************************************************
+/* File: ThreadPool.h
+/* Desc: Work stealing pool of worker threads shared by the bots, the headless games and the
+/*       benchmarks, and the task groups that fork jobs on it and join them
+/*****************************************************************************************/
+
+#ifndef _THREAD_POOL_
+#define _THREAD_POOL_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskGroup;
+
+class ThreadPool
+{
+public:
+
+	// Task of a loop: (worker running it, iteration). Each worker runs one iteration at a time
+	typedef std::function<void(int worker, int index)> Task;
+
+	explicit ThreadPool(int threads = 0, bool pin_threads = false);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator= (const ThreadPool&) = delete;
+
+	int GetWorkerCount() const;
+	int GetCurrentWorker() const;
+	void ParallelFor(int count, const Task& task);
+
+	static ThreadPool& GetGlobal();
+	static void SetGlobalThreads(int threads, bool pin_threads);
+
+private:
+
+	friend class TaskGroup;
+
+	struct Job
+	{
+		std::function<void()> function;
+		TaskGroup* group;
+		bool owned;								// Deleted once it has run, else it belongs to the caller
+	};
+
+	// Jobs of a worker (Chase-Lev deque): the worker pushes and pops them at the bottom, the
+	// other workers steal the oldest ones from the top
+	class JobDeque
+	{
+	public:
+
+		static const int kCapacity = 4096;
+
+		JobDeque();
+
+		bool Push(Job* job);
+		Job* Pop();
+		Job* Steal();
+
+	private:
+
+		alignas(64) std::atomic<int64_t> top_;
+		alignas(64) std::atomic<int64_t> bottom_;
+		std::atomic<Job*> jobs_[kCapacity];
+	};
+
+	std::vector<std::thread> threads_;
+	std::vector<std::unique_ptr<JobDeque>> deques_;	// One per worker, none for 0 (the threads out of the pool)
+
+	// Jobs submitted by the threads out of the pool. Any number of them can submit at the same time,
+	// so they share a locked bag instead of a deque; the workers take from it when theirs is empty
+	std::mutex injected_mutex_;
+	std::vector<Job*> injected_;				// Reserved for JobDeque::kCapacity jobs, never reallocated
+	std::atomic<int> injected_count_;			// Size of injected_, read without the lock
+
+	std::mutex mutex_;
+	std::condition_variable wake_;				// New jobs, or the pool is stopping
+	std::atomic<uint64_t> epoch_;				// Number of jobs submitted, the workers sleep until it changes
+	std::atomic<int> sleeping_;					// Workers waiting for jobs
+	std::atomic<bool> stop_;
+
+	void Submit(Job* job);
+	bool Inject(Job* job);
+	Job* TakeInjected(const TaskGroup* group);
+	bool RunJob(int worker, const TaskGroup* group);
+	static void Execute(Job* job);
+	void WorkerLoop(int worker);
+
+	static void PinThread(std::thread* thread, int cpu);
+};
+
+// Jobs forked on a pool and joined with Wait. The thread that waits runs jobs in the meantime,
+// so groups can be nested in the jobs of other groups
+class TaskGroup
+{
+public:
+
+	explicit TaskGroup(ThreadPool& pool = ThreadPool::GetGlobal());
+	~TaskGroup();
+
+	TaskGroup(const TaskGroup&) = delete;
+	TaskGroup& operator= (const TaskGroup&) = delete;
+
+	void Run(std::function<void()> function);
+	void Wait();
+	bool IsDone() const;
+
+private:
+
+	friend class ThreadPool;
+
+	ThreadPool& pool_;
+	std::atomic<int> pending_;					// Jobs forked and not finished yet
+};
+
+#endif // _THREAD_POOL_
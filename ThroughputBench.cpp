@@ -0,0 +1,234 @@
+/*****************************************************************************************
+/* File: ThroughputBench.cpp
+/* Desc: End to end benchmark of the headless game: complete games with fixed seeds and a
+/*       greedy placement policy, on 1..N workers of the thread pool.
+/*       Usage: ThroughputBench [--threads N] [--pin 0|1] [--games G] [--output file.csv]
+/*                              [--baseline file.csv] [--tolerance 0.1]
+/*****************************************************************************************/
+
+#include "Evaluator.h"
+#include "GameCore.h"
+#include "Policies.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	const uint64_t kSeed = 2024;
+	const int kMaxPieces = 1000;				// A game that reaches this number of pieces is stopped
+
+	struct Totals
+	{
+		int64_t games = 0;
+		int64_t pieces = 0;
+		int64_t lines = 0;
+	};
+
+	struct Result
+	{
+		int threads;
+		Totals totals;
+		double seconds;
+	};
+
+	/* 
+	======================================									
+	Play a whole game: every piece is dropped at the placement with the best evaluation, so the
+	games clear lines and last until kMaxPieces like real games. The policy has no randomness, the
+	game is the same on every run
+	====================================== 
+	*/
+	void PlayGame(uint64_t seed, const Evaluator& evaluator, Totals* totals)
+	{
+		GameCore core(seed);
+
+		while (!core.IsGameOver() && core.GetPieceCount() < kMaxPieces)
+			Policies::PlayGreedyPiece(core, evaluator);
+
+		totals->games++;
+		totals->pieces += core.GetPieceCount();
+		totals->lines += core.GetScore();
+	}
+
+	// Every thread plays its own range of seeds, so the totals don't depend on the scheduling. The
+	// ranges are the iterations of a loop on the pool, at most one per worker runs at a time
+	Result Run(int threads, int games_per_thread)
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		std::vector<Totals> totals(threads);
+		Evaluator evaluator;
+
+		Clock::time_point start = Clock::now();
+		ThreadPool::GetGlobal().ParallelFor(threads, [games_per_thread, &evaluator, &totals](int /*worker*/, int t) {
+			Totals local;
+			for (int i = 0; i < games_per_thread; i++)
+				PlayGame(kSeed + (uint64_t) t * games_per_thread + i, evaluator, &local);
+			totals[t] = local;
+		});
+
+		Result result;
+		result.threads = threads;
+		result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		for (const Totals& local : totals)
+		{
+			result.totals.games += local.games;
+			result.totals.pieces += local.pieces;
+			result.totals.lines += local.lines;
+		}
+		return result;
+	}
+
+	void PrintResult(FILE* file, const Result& result)
+	{
+		fprintf(file, "%d,%lld,%lld,%lld,%.4f,%.1f,%.1f,%.1f\n",
+			result.threads,
+			(long long) result.totals.games,
+			(long long) result.totals.pieces,
+			(long long) result.totals.lines,
+			result.seconds,
+			result.totals.games / result.seconds,
+			result.totals.pieces / result.seconds,
+			result.totals.lines / result.seconds);
+	}
+
+	const char* kHeader = "threads,games,pieces,lines,seconds,games_per_sec,pieces_per_sec,lines_per_sec\n";
+
+	// Reads the results of a previous run, written with PrintResult
+	std::vector<Result> ReadBaseline(const std::string& path)
+	{
+		std::vector<Result> baseline;
+
+		FILE* file = fopen(path.c_str(), "r");
+		if (file == nullptr)
+			return baseline;
+
+		char line[256];
+		while (fgets(line, sizeof(line), file) != nullptr)
+		{
+			Result result;
+			long long games, pieces, lines;
+			double games_per_sec, pieces_per_sec, lines_per_sec;
+			if (sscanf(line, "%d,%lld,%lld,%lld,%lf,%lf,%lf,%lf", &result.threads, &games, &pieces, &lines,
+				&result.seconds, &games_per_sec, &pieces_per_sec, &lines_per_sec) != 8)
+				continue;
+
+			result.totals.games = games;
+			result.totals.pieces = pieces;
+			result.totals.lines = lines;
+			baseline.push_back(result);
+		}
+
+		fclose(file);
+		return baseline;
+	}
+
+	/* 
+	======================================									
+	Compare the results with the baseline run that used the same number of threads
+
+	Returns the number of regressions: throughput lower than the baseline by more than the
+	tolerance, or different totals for the same games (the game logic changed)
+	====================================== 
+	*/
+	int CompareBaseline(const std::vector<Result>& results, const std::vector<Result>& baseline, double tolerance)
+	{
+		int regressions = 0;
+		for (const Result& result : results)
+		{
+			for (const Result& base : baseline)
+			{
+				if (base.threads != result.threads)
+					continue;
+
+				double speed = result.totals.pieces / result.seconds;
+				double base_speed = base.totals.pieces / base.seconds;
+				double change = speed / base_speed - 1.0;
+				bool slower = change < -tolerance;
+				bool different = base.totals.games == result.totals.games &&
+					(base.totals.pieces != result.totals.pieces || base.totals.lines != result.totals.lines);
+
+				printf("%2d threads: %+6.1f%% pieces/s vs baseline%s%s\n", result.threads, change * 100.0,
+					slower ? "  REGRESSION" : "", different ? "  DIFFERENT RESULTS" : "");
+
+				if (slower || different)
+					regressions++;
+			}
+		}
+		return regressions;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int max_threads = (int) std::thread::hardware_concurrency();
+	int games_per_thread = 100;
+	std::string output = "throughput_bench.csv";
+	std::string baseline_path;
+	double tolerance = 0.1;
+	bool pin_threads = false;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--threads") == 0)			max_threads = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--pin") == 0)			pin_threads = atoi(argv[i + 1]) != 0;
+		else if (strcmp(argv[i], "--games") == 0)		games_per_thread = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--output") == 0)		output = argv[i + 1];
+		else if (strcmp(argv[i], "--baseline") == 0)	baseline_path = argv[i + 1];
+		else if (strcmp(argv[i], "--tolerance") == 0)	tolerance = atof(argv[i + 1]);
+		else
+		{
+			fprintf(stderr, "Unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+
+	if (max_threads < 1)
+		max_threads = 1;
+	ThreadPool::SetGlobalThreads(max_threads, pin_threads);
+
+	// 1, 2, 4, ... threads and always the maximum
+	std::vector<Result> results;
+	printf("%s", kHeader);
+	for (int threads = 1; ; threads = threads * 2 < max_threads ? threads * 2 : max_threads)
+	{
+		results.push_back(Run(threads, games_per_thread));
+		PrintResult(stdout, results.back());
+
+		if (threads == max_threads)
+			break;
+	}
+
+	FILE* file = fopen(output.c_str(), "w");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Can't write %s\n", output.c_str());
+		return 1;
+	}
+	fprintf(file, "%s", kHeader);
+	for (const Result& result : results)
+		PrintResult(file, result);
+	fclose(file);
+
+	if (!baseline_path.empty())
+	{
+		std::vector<Result> baseline = ReadBaseline(baseline_path);
+		if (baseline.empty())
+		{
+			fprintf(stderr, "Can't read the baseline %s\n", baseline_path.c_str());
+			return 1;
+		}
+
+		if (CompareBaseline(results, baseline, tolerance) > 0)
+			return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,164 @@
+/*****************************************************************************************
+/* File: TranspositionTable.cpp
+/* Desc: Fixed size table of the scores of the positions met by the bots, shared by the
+/*       search threads without locks
+/*****************************************************************************************/
+
+#include "TranspositionTable.h"
+#include <cstring>
+
+/* 
+======================================									
+All the memory is allocated here, the table never allocates afterwards
+
+Parameters:
+
+>> megabytes:	Size of the table, rounded down to a power of two number of buckets
+====================================== 
+*/
+TranspositionTable::TranspositionTable(int megabytes)
+{
+	uint64_t buckets = 1;
+	while (buckets * 2 * sizeof(Bucket) <= (uint64_t) megabytes * 1024 * 1024)
+		buckets *= 2;
+
+	this->buckets_.reset(new Bucket[buckets]);
+	this->mask_ = buckets - 1;
+	this->age_ = 0;
+	this->Clear();
+}
+
+void TranspositionTable::Clear()
+{
+	for (uint64_t i = 0; i <= this->mask_; i++)
+	{
+		for (Slot& slot : this->buckets_[i].slots)
+		{
+			slot.check.store(0, std::memory_order_relaxed);
+			slot.data.store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+/* 
+======================================									
+Start a new search, the entries of the previous searches are replaced first. When the age wraps
+the table is cleared, else the entries of the search 65536 searches ago would look current
+====================================== 
+*/
+void TranspositionTable::NewSearch()
+{
+	this->age_++;
+	if (this->age_ == 0)
+		this->Clear();
+}
+
+// Age of the entries stored by the current search
+int TranspositionTable::GetAge() const
+{
+	return this->age_;
+}
+
+size_t TranspositionTable::GetEntryCount() const
+{
+	return (size_t) (this->mask_ + 1) * kBucketEntries;
+}
+
+/* 
+======================================									
+Look for a position
+
+Parameters:
+
+>> key:		Hash of the position
+>> entry:	Receives the entry of the position if it is found
+
+Returns true if the position is in the table.
+====================================== 
+*/
+bool TranspositionTable::Probe(uint64_t key, Entry* entry) const
+{
+	const Bucket& bucket = this->buckets_[key & this->mask_];
+
+	for (const Slot& slot : bucket.slots)
+	{
+		uint64_t data = slot.data.load(std::memory_order_relaxed);
+		if (data != 0 && (slot.check.load(std::memory_order_relaxed) ^ data) == key)
+		{
+			TranspositionTable::Unpack(data, entry);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* 
+======================================									
+Keep the score of a position. It goes in the entry of the same position (unless it has a deeper
+score of this search), or an empty one, or else replaces the entry of an older search or, in the
+current search, the shallowest one
+
+Parameters:
+
+>> key:		Hash of the position
+>> score:	Score of the position
+>> depth:	Pieces searched to get the score, 0 = evaluation of the board
+====================================== 
+*/
+void TranspositionTable::Store(uint64_t key, float score, int depth)
+{
+	Bucket& bucket = this->buckets_[key & this->mask_];
+
+	Slot* victim = nullptr;
+	int victim_value = 0;
+	for (Slot& slot : bucket.slots)
+	{
+		uint64_t data = slot.data.load(std::memory_order_relaxed);
+		if (data == 0)
+		{
+			victim = &slot;
+			break;
+		}
+
+		Entry entry;
+		TranspositionTable::Unpack(data, &entry);
+
+		if ((slot.check.load(std::memory_order_relaxed) ^ data) == key)
+		{
+			// A deeper score of this search is worth more than this one
+			if (entry.age == this->age_ && entry.depth > depth)
+				return;
+			victim = &slot;
+			break;
+		}
+
+		int value = (entry.age == this->age_ ? 256 : 0) + entry.depth;		// Depths fit in 8 bits
+		if (victim == nullptr || value < victim_value)
+		{
+			victim = &slot;
+			victim_value = value;
+		}
+	}
+
+	uint64_t data = TranspositionTable::Pack(score, depth, this->age_);
+	victim->check.store(key ^ data, std::memory_order_relaxed);
+	victim->data.store(data, std::memory_order_relaxed);
+}
+
+// Score in the low 32 bits, then 8 bits of depth and 16 bits of age. The top bit is set, so the
+// data of a stored entry is never 0
+uint64_t TranspositionTable::Pack(float score, int depth, int age)
+{
+	uint32_t bits;
+	memcpy(&bits, &score, sizeof(bits));
+	return (uint64_t) bits | ((uint64_t) (uint8_t) depth << 32) | ((uint64_t) (uint16_t) age << 40) | (1ull << 63);
+}
+
+void TranspositionTable::Unpack(uint64_t data, Entry* entry)
+{
+	uint32_t bits = (uint32_t) data;
+	memcpy(&entry->score, &bits, sizeof(bits));
+	entry->depth = (uint8_t) (data >> 32);
+	entry->age = (uint16_t) (data >> 40);
+}
@@ -0,0 +1,62 @@
+/*****************************************************************************************
+/* File: TranspositionTable.h
+/* Desc: Fixed size table of the scores of the positions met by the bots, shared by the
+/*       search threads without locks
+/*****************************************************************************************/
+
+#ifndef _TRANSPOSITION_TABLE_
+#define _TRANSPOSITION_TABLE_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class TranspositionTable
+{
+public:
+
+	static const int kBucketEntries = 4;		// Entries of a bucket, a bucket is one cache line
+
+	struct Entry
+	{
+		float score;
+		int depth;								// Pieces searched under the position, 0 = evaluation of the board
+		int age;								// Search that stored the entry
+	};
+
+	explicit TranspositionTable(int megabytes);
+
+	void Clear();
+	void NewSearch();
+
+	bool Probe(uint64_t key, Entry* entry) const;
+	void Store(uint64_t key, float score, int depth);
+
+	int GetAge() const;
+	size_t GetEntryCount() const;
+
+private:
+
+	// The key is stored XORed with the data, an entry torn by two threads writing it at the same
+	// time doesn't match its key any more and is ignored
+	struct Slot
+	{
+		std::atomic<uint64_t> check;			// Key ^ data
+		std::atomic<uint64_t> data;				// Score, depth and age, 0 = empty
+	};
+
+	struct alignas(64) Bucket
+	{
+		Slot slots[kBucketEntries];
+	};
+
+	std::unique_ptr<Bucket[]> buckets_;
+	uint64_t mask_;								// Number of buckets - 1, a power of two
+	uint16_t age_;								// Wraps to 0 every 65536 searches, the table is cleared then
+
+	static uint64_t Pack(float score, int depth, int age);
+	static void Unpack(uint64_t data, Entry* entry);
+};
+
+#endif // _TRANSPOSITION_TABLE_
@@ -0,0 +1,132 @@
+/*****************************************************************************************
+/* File: Zobrist.h
+/* Desc: Zobrist keys for hashing boards and game states. The keys are generated at compile
+/*       time, so they are the same in every build and on every machine
+/*****************************************************************************************/
+
+#ifndef _ZOBRIST_
+#define _ZOBRIST_
+
+#include "Pieces.h"
+#include <cstdint>
+
+namespace Zobrist
+{
+	const int kMaxColumns = 16;			// Widest board with keys
+	const int kMaxLines = 32;			// Highest board with keys
+	const int kNibbles = kMaxColumns / 4;
+	const int kPositionOffset = 8;		// Positions of the piece matrix go from -kPositionOffset
+	const int kPositions = 48;
+	const int kQueueSlots = 8;			// Upcoming pieces that can be hashed
+
+	constexpr uint64_t SplitMix(uint64_t x)
+	{
+		x += 0x9e3779b97f4a7c15ull;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+		return x ^ (x >> 31);
+	}
+
+	// Every family of keys uses its own range of inputs of SplitMix
+	constexpr uint64_t CellKey(int x, int y)			{ return SplitMix(0x100000ull + ((uint64_t) y << 10) + x); }
+	constexpr uint64_t PieceKey(int piece, int rotation)	{ return SplitMix(0x200000ull + piece * Pieces::kRotations + rotation); }
+	constexpr uint64_t PosXKey(int x)					{ return SplitMix(0x300000ull + x + kPositionOffset); }
+	constexpr uint64_t PosYKey(int y)					{ return SplitMix(0x400000ull + y + kPositionOffset); }
+	constexpr uint64_t QueueKey(int slot, int piece)	{ return SplitMix(0x500000ull + slot * Pieces::kPieceKinds + piece); }
+	constexpr uint64_t QueueRotationKey(int slot, int rotation)	{ return SplitMix(0x600000ull + slot * Pieces::kRotations + rotation); }
+	constexpr uint64_t FallTimeKey(int ms)				{ return SplitMix(0x700000ull + ms); }
+	constexpr uint64_t RandomizerKey(uint64_t state)	{ return SplitMix(0x800000ull ^ SplitMix(state)); }	// The state is mixed first, it has any value
+
+	struct Tables
+	{
+		uint64_t lines[kMaxLines][kNibbles][16];	// XOR of the keys of the cells set in each group of 4 columns of a line
+		uint64_t pieces[Pieces::kPieceKinds][Pieces::kRotations];
+		uint64_t pos_x[kPositions];
+		uint64_t pos_y[kPositions];
+		uint64_t queue[kQueueSlots][Pieces::kPieceKinds];
+		uint64_t queue_rotations[kQueueSlots][Pieces::kRotations];
+	};
+
+	constexpr Tables MakeTables()
+	{
+		Tables tables = {};
+
+		for (int y = 0; y < kMaxLines; y++)
+			for (int nibble = 0; nibble < kNibbles; nibble++)
+				for (int bits = 0; bits < 16; bits++)
+					for (int i = 0; i < 4; i++)
+						if (bits & (1 << i))
+							tables.lines[y][nibble][bits] ^= CellKey(nibble * 4 + i, y);
+
+		for (int piece = 0; piece < Pieces::kPieceKinds; piece++)
+			for (int rotation = 0; rotation < Pieces::kRotations; rotation++)
+				tables.pieces[piece][rotation] = PieceKey(piece, rotation);
+
+		for (int i = 0; i < kPositions; i++)
+		{
+			tables.pos_x[i] = PosXKey(i - kPositionOffset);
+			tables.pos_y[i] = PosYKey(i - kPositionOffset);
+		}
+
+		for (int slot = 0; slot < kQueueSlots; slot++)
+			for (int piece = 0; piece < Pieces::kPieceKinds; piece++)
+				tables.queue[slot][piece] = QueueKey(slot, piece);
+
+		for (int slot = 0; slot < kQueueSlots; slot++)
+			for (int rotation = 0; rotation < Pieces::kRotations; rotation++)
+				tables.queue_rotations[slot][rotation] = QueueRotationKey(slot, rotation);
+
+		return tables;
+	}
+
+	inline constexpr Tables kTables = MakeTables();
+
+	/*
+	======================================
+	Returns the XOR of the keys of the filled cells of one line
+
+	Parameters:
+
+	>> y:		Vertical position of the line in blocks
+	>> mask:	Occupancy mask of the line (bit x = column x)
+	======================================
+	*/
+	inline uint64_t GetLineKey(int y, unsigned int mask)
+	{
+		uint64_t key = 0;
+		for (int nibble = 0; mask != 0; nibble++, mask >>= 4)
+			key ^= kTables.lines[y][nibble][mask & 15];
+		return key;
+	}
+
+	// Key of the falling piece: kind, rotation and position
+	inline uint64_t GetPieceKey(int piece, int rotation, int x, int y)
+	{
+		return kTables.pieces[piece][rotation] ^ kTables.pos_x[x + kPositionOffset] ^ kTables.pos_y[y + kPositionOffset];
+	}
+
+	inline uint64_t GetQueueKey(int slot, int piece)
+	{
+		return kTables.queue[slot][piece];
+	}
+
+	// Key of the rotation an upcoming piece will appear with, the bots don't need it
+	inline uint64_t GetQueueRotationKey(int slot, int rotation)
+	{
+		return kTables.queue_rotations[slot][rotation];
+	}
+
+	// Key of the time since the falling piece last went down, it has too many values for a table
+	inline uint64_t GetFallTimeKey(int ms)
+	{
+		return FallTimeKey(ms);
+	}
+
+	// Key of the memory of a randomizer (Randomizer::GetState), for the values that depend on the next pieces
+	inline uint64_t GetRandomizerKey(uint64_t state)
+	{
+		return RandomizerKey(state);
+	}
+}
+
+#endif // _ZOBRIST_